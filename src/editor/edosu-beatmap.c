@@ -112,8 +112,10 @@ edosu_beatmap_load_from_file(EdosuBeatmap *beatmap, gchar const *filepath)
         set_path(beatmap, filepath);
         int64_t end_time = osux_bm.hitobjects[osux_bm.hitobject_count-1].offset;
         int64_t beatlength = 1000;
-        if(osux_bm.timingpoint_count > 0)
-            beatlength = osux_bm.timingpoints[0].millisecond_per_beat;
+        osux_timingpoint const *tp = osux_timing_index_uninherited_at(
+            &osux_bm.timing_index, 0);
+        if (tp != NULL)
+            beatlength = tp->millisecond_per_beat;
         edosu_view_set_max_time(beatmap->view, end_time + 5000, beatlength);
         edosu_beatmap_load_objects(beatmap, &osux_bm);
         edosu_view_set_hit_objects(beatmap->view, beatmap->HitObjectsSeq);
@@ -3,13 +3,18 @@
 
 #include "./osux/gettext.h"
 #include "./osux/timingpoint.h"
+#include "./osux/timing_index.h"
 #include "./osux/keys.h"
 #include "./osux/hit.h"
+#include "./osux/hit_analysis.h"
 #include "./osux/replay.h"
+#include "./osux/replay_frames.h"
 #include "./osux/mods.h"
 #include "./osux/beatmap.h"
 #include "./osux/database.h"
 #include "./osux/beatmap_database.h"
+#include "./osux/hash_index.h"
+#include "./osux/beatmap_db_server.h"
 #include "./osux/error.h"
 #include "./osux/string.h"
 #include "./osux/beatmap_set.h"
@@ -31,6 +31,7 @@
 
 #include "osux/color.h"
 #include "osux/timingpoint.h"
+#include "osux/timing_index.h"
 #include "osux/event.h"
 
 G_BEGIN_DECLS
@@ -148,10 +149,12 @@ struct osux_beatmap_ {
     uint32_t timingpoint_count;
     uint32_t timingpoint_bufsize;
     osux_timingpoint *timingpoints;
+    osux_timing_index timing_index; // built by osux_beatmap_prepare
 
     uint32_t hitobject_count;
     uint32_t hitobject_bufsize;
     osux_hitobject *hitobjects;
+    // options without a field above: section name -> (key -> value string)
     osux_hashtable *sections;
 
     osux_hashtable *h_data;
@@ -159,6 +162,13 @@ struct osux_beatmap_ {
 };
 
 int MUST_CHECK osux_beatmap_init(osux_beatmap *beatmap, char const *filename);
+/*
+ * Only read what the beatmap database needs: options, timing points and
+ * hit object statistics. Hit objects are counted but not stored, events
+ * and colours are skipped and the beatmap is not prepared.
+ */
+int MUST_CHECK osux_beatmap_init_metadata(osux_beatmap *beatmap,
+                                          char const *filename);
 int osux_beatmap_free(osux_beatmap *beatmap);
 char *osux_beatmap_default_filename(osux_beatmap const *bm);
 int MUST_CHECK osux_beatmap_prepare(osux_beatmap *beatmap);
@@ -185,9 +195,65 @@ void osux_beatmap_append_timingpoint(osux_beatmap *beatmap, osux_timingpoint *tp
 void osux_beatmap_append_event(osux_beatmap *beatmap, osux_event *ev);
 void osux_beatmap_append_color(osux_beatmap *beatmap, osux_color *c);
 
+/*
+ * Compact binary cache ('.osub'): the parsed beatmap stored as flat
+ * arrays and a string pool, loaded back with a single mapping and no
+ * text parsing. Loading a saved beatmap gives back the same beatmap;
+ * files written by a build with a different struct layout are rejected
+ * with OSUX_ERR_BINARY_VERSION.
+ */
+int osux_beatmap_save_binary(osux_beatmap const *beatmap, char const *path);
+int MUST_CHECK osux_beatmap_load_binary(osux_beatmap *beatmap, char const *path);
+/* "<cache_dir>/<md5_hash>.osub" */
+char *osux_beatmap_binary_cache_path(char const *cache_dir,
+                                     char const *md5_hash);
+/*
+ * Like 'osux_beatmap_init' but looks up the cache first (by the md5 of the
+ * file) and fills it on a miss. 'cache_dir' may be NULL to disable the cache.
+ */
+int MUST_CHECK osux_beatmap_init_cached(osux_beatmap *beatmap,
+                                        char const *file_path,
+                                        char const *cache_dir);
+
 /* return the circle radius in scene pixel */
 int osux_get_circle_size(double circle_size, int mods);
 
+/*
+ * Load several beatmaps concurrently with a pool of worker threads.
+ * 'callback' is always called from the calling thread, once per path,
+ * with the index of the path in 'paths' and the result of
+ * 'osux_beatmap_init'. 'beatmap' is NULL when 'err' is negative.
+ * The beatmap is freed when the callback returns.
+ * The number of beatmaps parsed but not yet delivered is bounded
+ * so memory usage does not grow with 'path_count'.
+ */
+enum osux_beatmap_load_flags {
+    // deliver beatmaps in the order of 'paths' instead of completion order
+    OSUX_BEATMAP_LOAD_ORDERED = 1 << 0,
+    // use 'osux_beatmap_init_metadata' instead of 'osux_beatmap_init'
+    OSUX_BEATMAP_LOAD_METADATA = 1 << 1,
+};
+
+typedef void (*osux_beatmap_load_fn)(
+    osux_beatmap *beatmap, unsigned index, int err, void *user_data);
+
+int osux_beatmap_load_many(char const *const *paths, unsigned path_count,
+                           int flags, osux_beatmap_load_fn callback,
+                           void *user_data);
+
+typedef struct osux_beatmap_load_options_ {
+    int flags; // osux_beatmap_load_flags
+    // full parses go through 'osux_beatmap_init_cached', NULL for none
+    char const *cache_dir;
+    // worker threads, 0 for one per processor
+    unsigned thread_count;
+} osux_beatmap_load_options;
+
+/* 'options' may be NULL for the defaults (no flag, no cache, 0 threads) */
+int osux_beatmap_load_many_ex(char const *const *paths, unsigned path_count,
+                              osux_beatmap_load_options const *options,
+                              osux_beatmap_load_fn callback, void *user_data);
+
 
 G_END_DECLS
 
@@ -5,6 +5,9 @@
 #include <glib.h>
 
 #include "osux/database.h"
+#include "osux/beatmap.h"
+#include "osux/beatmap_set.h"
+#include "osux/hash_index.h"
 
 G_BEGIN_DECLS
 
@@ -13,15 +16,80 @@ typedef struct osux_beatmap_database_ {
     char *song_dir;
     size_t song_dir_length;
     uint64_t parsed_beatmap_count;
-    bool insert_prepared;
+    // statements from the database cache
+    osux_database_stmt *insert_stmt;
+    int *insert_params; // parameter index of each column of 'insert_stmt'
+    osux_database_stmt *path_by_hash_stmt;
+    osux_hash_index *hash_index; // NULL until loaded
+    GHashTable *set_ids; // directory -> beatmap_set_id (int64_t*)
+
+    unsigned bulk_size; // 0 outside of a bulk insert
+    unsigned bulk_pending;
+    int64_t last_progress;
 } osux_beatmap_db;
 
 int osux_beatmap_db_free(osux_beatmap_db *db);
 char *osux_beatmap_db_get_path_by_hash(osux_beatmap_db *db, char const *md5_hash);
+enum osux_beatmap_db_flags {
+    // rebuild the whole database from the song directory
+    OSUX_BEATMAP_DB_POPULATE = 1 << 0,
+    // lookups only: the file is opened read only and its schema is never
+    // upgraded (an outdated one is an error)
+    OSUX_BEATMAP_DB_READ_ONLY = 1 << 1,
+};
+
+/* on error, everything is freed already */
 int osux_beatmap_db_init(osux_beatmap_db *db, char const *file_path,
-                         char const *song_dir, bool populate);
+                         char const *song_dir, int flags);
 int osux_beatmap_db_dump(osux_beatmap_db *db, FILE *out);
 
+/*
+ * Bulk insertion: rows inserted between 'bulk_begin' and 'bulk_end' are
+ * committed 'batch_size' at a time instead of in one transaction each.
+ */
+int osux_beatmap_db_bulk_begin(osux_beatmap_db *db, unsigned batch_size);
+int osux_beatmap_db_bulk_end(osux_beatmap_db *db);
+int osux_beatmap_db_insert(osux_beatmap_db *db, osux_beatmap const *bm,
+                           int64_t file_size);
+
+/*
+ * Load all md5 -> path pairs in memory so hash lookups no longer go
+ * through SQLite. With a 'sidecar_path', the index is read from that file
+ * when it is newer than the database and written to it otherwise.
+ * The index is a snapshot: rows inserted afterwards are not in it.
+ */
+int osux_beatmap_db_load_hash_index(osux_beatmap_db *db,
+                                    char const *sidecar_path);
+/*
+ * out_paths[i] is the (newly allocated) path of hashes[i], or NULL when
+ * not found. Return the number of hashes found.
+ */
+unsigned osux_beatmap_db_resolve_many(osux_beatmap_db *db,
+                                      char const *const *hashes,
+                                      unsigned count, char **out_paths);
+
+/*
+ * All the difficulties sharing the set of the given beatmap, as a NULL
+ * terminated array to free with g_strfreev; NULL if the hash is unknown
+ * or on error.
+ */
+char **osux_beatmap_db_get_set_paths_by_hash(osux_beatmap_db *db,
+                                             char const *md5_hash);
+/* fill 'set' (free it with osux_beatmap_set_free) */
+int osux_beatmap_db_get_set_by_hash(osux_beatmap_db *db, char const *md5_hash,
+                                    osux_beatmap_set *set);
+
+/*
+ * Call 'callback' on the row of the beatmap stored at 'file_path'
+ * (relative to song_dir), with md5_hash as an hex string.
+ */
+int osux_beatmap_db_foreach_metadata_by_path(
+    osux_beatmap_db *db, char const *file_path,
+    osux_database_row_fn callback, void *user_data);
+
+/* rescan song_dir, only parsing files whose size or mtime changed */
+int osux_beatmap_db_sync(osux_beatmap_db *db);
+
 G_END_DECLS
 
 #endif // OSUX_BEATMAP_DATABASE_H
@@ -0,0 +1,71 @@
+#ifndef OSUX_BEATMAP_DB_SERVER_H
+#define OSUX_BEATMAP_DB_SERVER_H
+
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <signal.h>
+#include <glib.h>
+
+#include "osux/beatmap_database.h"
+#include "osux/hash_table.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Beatmap database lookups over a local UNIX socket, so that short lived
+ * processes do not have to open the database and build the hash index
+ * for each query.
+ *
+ * The protocol is line based. Requests:
+ *     hash <md5>     path of the beatmap
+ *     set <md5>      paths of all the difficulties of its set
+ *     path <path>    columns of the beatmap stored at this path
+ * Each reply is either "+<n>" followed by n lines ("column\tvalue" lines
+ * for 'path', NULL columns omitted), or "-<message>" for a bad request.
+ * An unknown beatmap is "+0". Requests can be pipelined, replies come
+ * back in order.
+ */
+
+/* answer queries until *stop becomes non-zero (may be NULL) */
+int osux_beatmap_db_serve(osux_beatmap_db *db, char const *socket_path,
+                          sig_atomic_t volatile const *stop);
+
+typedef struct osux_beatmap_db_client_ {
+    int fd;
+    GString *input; // received data not consumed yet
+} osux_beatmap_db_client;
+
+int osux_beatmap_db_client_connect(osux_beatmap_db_client *client,
+                                   char const *socket_path);
+void osux_beatmap_db_client_close(osux_beatmap_db_client *client);
+
+/* same as the osux_beatmap_db functions of the same name */
+char *osux_beatmap_db_client_get_path_by_hash(osux_beatmap_db_client *client,
+                                              char const *md5_hash);
+unsigned osux_beatmap_db_client_resolve_many(osux_beatmap_db_client *client,
+                                             char const *const *hashes,
+                                             unsigned count, char **out_paths);
+char **osux_beatmap_db_client_get_set_paths_by_hash(
+    osux_beatmap_db_client *client, char const *md5_hash);
+
+/* column name -> value (char*), NULL when the path is unknown */
+osux_hashtable *osux_beatmap_db_client_get_metadata(
+    osux_beatmap_db_client *client, char const *file_path);
+
+G_END_DECLS
+
+#endif // OSUX_BEATMAP_DB_SERVER_H
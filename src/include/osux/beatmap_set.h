@@ -1,6 +1,11 @@
 #ifndef OSUX_BEATMAP_SET_H
 #define OSUX_BEATMAP_SET_H
 
+#include <stdint.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
 typedef struct osux_beatmap_set_ osux_beatmap_set;
 
 struct osux_beatmap_set_ {
@@ -17,6 +22,19 @@ struct osux_beatmap_set_ {
     char *source;
     char *directory;
     int32_t status;
+
+    // over all the difficulties of the set
+    uint32_t difficulty_count;
+    int32_t bpm_min;
+    int32_t bpm_max;
+    int32_t object_count_min;
+    int32_t object_count_max;
+    int32_t drain_time_min;
+    int32_t drain_time_max;
 };
 
+void osux_beatmap_set_free(osux_beatmap_set *set);
+
+G_END_DECLS
+
 #endif // OSUX_BEATMAP_SET_H
@@ -21,18 +21,75 @@
 #include <stdint.h>
 #include <glib.h>
 
+#include "osux/error.h"
+
 G_BEGIN_DECLS
 
+/*
+ * Reader over a borrowed buffer (typically a mapped file): the data is
+ * never copied nor modified, views returned by the reader point into it.
+ * Every read is bounds-checked and fails with -OSUX_ERR_BUFFER_READER_RANGE
+ * without moving the read pointer.
+ */
 typedef struct osux_buffer_reader_ {
-    void *data;
+    uint8_t const *data;
     size_t size;
-    uint64_t r; // read pointer
+    uint64_t r; // read pointer, never beyond 'size'
 } osux_buffer_reader;
 
-int osux_buffer_reader_init(osux_buffer_reader *br, void *data, size_t size);
+/* a range of the reader's data, valid as long as the data is */
+typedef struct osux_buffer_view_ {
+    char const *ptr; // NULL for an absent string
+    size_t len;
+} osux_buffer_view;
+
+int osux_buffer_reader_init(osux_buffer_reader *br,
+                            void const *data, size_t size);
+
+static inline size_t osux_buffer_reader_left(osux_buffer_reader const *br)
+{
+    return br->size - br->r;
+}
+
+/* fixed width little-endian integers */
+#define OSUX_BUFFER_READER_READ_LE(type_, name_)                        \
+    static inline int                                                   \
+    osux_buffer_reader_read_##name_(osux_buffer_reader *br, type_ *value) \
+    {                                                                   \
+        if (osux_buffer_reader_left(br) < sizeof (type_))               \
+            return -OSUX_ERR_BUFFER_READER_RANGE;                       \
+        uint8_t const *p = br->data + br->r;                            \
+        uint64_t v = 0;                                                 \
+        for (unsigned i = sizeof (type_); i-- > 0; )                    \
+            v = v << 8 | p[i];                                          \
+        *value = (type_) v;                                             \
+        br->r += sizeof (type_);                                        \
+        return 0;                                                       \
+    }
+
+OSUX_BUFFER_READER_READ_LE(uint8_t, u8)
+OSUX_BUFFER_READER_READ_LE(uint16_t, u16)
+OSUX_BUFFER_READER_READ_LE(uint32_t, u32)
+OSUX_BUFFER_READER_READ_LE(uint64_t, u64)
+
+/* copy the next 'size' bytes to 'data' */
 ssize_t osux_buffer_reader_read(osux_buffer_reader *br, void *data, size_t size);
+/* the next 'size' bytes, in place */
+int osux_buffer_reader_read_view(osux_buffer_reader *br, size_t size,
+                                 osux_buffer_view *view);
 int osux_buffer_reader_read_uleb128(osux_buffer_reader *br, uint64_t *value);
+
+/*
+ * osu! strings: a 0x00 byte for an absent string (view->ptr is NULL, *value
+ * is left untouched), or 0x0b, the length (uleb128) and the bytes
+ */
+int osux_buffer_reader_read_string_view(osux_buffer_reader *br,
+                                        osux_buffer_view *view);
+/* g_free'd copy of the string, null terminated */
 int osux_buffer_reader_read_string(osux_buffer_reader *br, char **value);
+int osux_buffer_reader_skip_string(osux_buffer_reader *br);
+
+/* decompress the next 'size' bytes into *value, to be g_free'd */
 int osux_buffer_reader_read_lzma(
     osux_buffer_reader *br, char **value, size_t size);
 int osux_buffer_reader_free(osux_buffer_reader *br);
@@ -23,12 +23,34 @@
 #define MUST_CHECK __attribute__((warn_unused_result))
 #define likely(x) (__builtin_constant_p(x) ? (x) : __builtin_expect(!!(x), 1))
 #define unlikely(x) (__builtin_constant_p(x) ? (x) : __builtin_expect(!!(x), 0))
+#define osux_popcount32(x) ((unsigned) __builtin_popcount(x))
+// 'x' must not be 0
+#define osux_ctz64(x) ((unsigned) __builtin_ctzll(x))
 #else
 
+#include <stdint.h>
+
 #define UNUSED
 #define MUST_CHECK
 #define likely(x) (x)
 #define unlikely(x) (x)
+
+static inline unsigned osux_popcount32(uint32_t x)
+{
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    return (((x + (x >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+static inline unsigned osux_ctz64(uint64_t x)
+{
+    unsigned n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        ++ n;
+    }
+    return n;
+}
 #endif // __GNUC__
 
 #define MARK_USED(x) ((void) (x))
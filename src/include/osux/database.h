@@ -3,34 +3,109 @@
 
 #include <sqlite3.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <glib.h>
 #include "osux/list.h"
 
 G_BEGIN_DECLS
 
+/* prepared statement owned by the database statement cache */
+typedef struct osux_database_stmt_ osux_database_stmt;
+
 typedef struct osux_database_ {
 
     sqlite3 *mem_handle;
     sqlite3 *file_handle;
     bool in_memory;
+    bool read_only;
     char *file_path;
 
-    sqlite3_stmt *prepared_query;
+    sqlite3_stmt *prepared_query; // current statement, from 'statements'
+    GHashTable *statements; // SQL text -> osux_database_stmt*
 } osux_database;
 
+/*
+ * Current row of a query, only valid inside the row callback.
+ * Text and blob values are borrowed from SQLite: copy them to keep them
+ * after the callback returns.
+ */
+typedef struct osux_database_row_ osux_database_row;
+
+/* return non-zero to stop the iteration */
+typedef int (*osux_database_row_fn)(osux_database_row const *row,
+                                    void *user_data);
+
+enum osux_database_flags {
+    // work on a copy of the whole database loaded in memory, for bulk
+    // writes; changes reach the file only with 'osux_database_save'
+    OSUX_DATABASE_IN_MEMORY = 1 << 0,
+    OSUX_DATABASE_READ_ONLY = 1 << 1,
+    // with OSUX_DATABASE_IN_MEMORY: start from an empty database instead
+    // of a copy, 'osux_database_save' then replaces the file content
+    OSUX_DATABASE_EMPTY = 1 << 2,
+};
+
+int osux_database_open(osux_database *db, char const *file_path, int flags);
+/* same as osux_database_open(db, file_path, 0) */
 int osux_database_init(osux_database *db, char const *file_path);
+/* write the in-memory copy back to the file; no-op in file mode */
+int osux_database_save(osux_database *db);
+/* unsaved changes of an in-memory database are lost */
 void osux_database_free(osux_database *db);
 
 int osux_database_exec_query(
     osux_database *db, char const *query, osux_list *query_result);
 int osux_database_print_query(osux_database *db, char const *query, FILE *out);
 
+/*
+ * Each distinct SQL text is prepared once per connection and kept until
+ * 'osux_database_free'. 'osux_database_prepare_query' looks the query up
+ * in that cache and makes it the current statement; callers executing
+ * the same query often can keep the handle and skip the lookup.
+ */
 int osux_database_prepare_query(osux_database *db, char const *query);
+osux_database_stmt *osux_database_statement(osux_database *db,
+                                            char const *query);
+void osux_database_use_statement(osux_database *db, osux_database_stmt *stmt);
 int osux_database_bind_int(osux_database *db, char const *name, int i);
+int osux_database_bind_int64(osux_database *db, char const *name, int64_t i);
 int osux_database_bind_double(osux_database *db, char const *name, double d);
 int osux_database_bind_string(osux_database *db, char const *name, char const *str);
+/*
+ * Same as above with the parameter index instead of its name, to avoid the
+ * name lookup when the same query is executed many times.
+ * The string is not copied: it must stay valid until the query is executed.
+ */
+int osux_database_parameter_index(osux_database *db, char const *name);
+int osux_database_bind_int_at(osux_database *db, int index, int i);
+int osux_database_bind_int64_at(osux_database *db, int index, int64_t i);
+int osux_database_bind_double_at(osux_database *db, int index, double d);
+int osux_database_bind_string_at(osux_database *db, int index, char const *str);
+/* the blob is copied */
+int osux_database_bind_blob_at(osux_database *db, int index,
+                               void const *data, int size);
 int osux_database_exec_prepared_query(osux_database *db, osux_list *query_result);
 
+/*
+ * Call 'callback' for each row of the prepared query / of 'query',
+ * with typed access to the columns and no copy of the values.
+ * 'osux_database_exec_prepared_query' is a wrapper building a list of
+ * hashtables on top of it.
+ */
+int osux_database_foreach_prepared_row(
+    osux_database *db, osux_database_row_fn callback, void *user_data);
+int osux_database_foreach_row(osux_database *db, char const *query,
+                              osux_database_row_fn callback, void *user_data);
+
+int osux_database_column_count(osux_database_row const *row);
+char const *osux_database_column_name(osux_database_row const *row, int col);
+bool osux_database_column_is_null(osux_database_row const *row, int col);
+int64_t osux_database_column_int64(osux_database_row const *row, int col);
+double osux_database_column_double(osux_database_row const *row, int col);
+char const *osux_database_column_text(osux_database_row const *row, int col);
+void const *osux_database_column_blob(osux_database_row const *row, int col,
+                                      int *size);
+
 G_END_DECLS
 
 #endif // OSUX_DATABASE_H
@@ -46,6 +46,9 @@ G_BEGIN_DECLS
     ERROR(OSUX_ERR_AUTOCONVERT_NOT_SUPPORTED)           \
     ERROR(OSUX_ERR_INVALID_GAME_MODE)                   \
     ERROR(OSUX_ERR_GAME_MODE_NOT_SUPPORTED)             \
+    ERROR(OSUX_ERR_INVALID_BINARY)                      \
+    ERROR(OSUX_ERR_BINARY_VERSION)                      \
+    ERROR(OSUX_ERR_SOCKET)                              \
 
 
 #define OSUX_ERROR_TO_ENUM(error) error,
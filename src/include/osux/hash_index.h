@@ -0,0 +1,91 @@
+#ifndef OSUX_HASH_INDEX_H
+#define OSUX_HASH_INDEX_H
+
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <glib.h>
+
+#include "osux/compiler.h"
+
+G_BEGIN_DECLS
+
+/*
+ * In memory md5 -> beatmap path map, for resolving many replay hashes
+ * without going through SQLite.
+ *
+ * Entries hold the 16 byte binary digest and the offset of the path in a
+ * single string pool; they are sorted by digest and searched by bisection.
+ * The index can be saved to and loaded from a sidecar file holding the
+ * same arrays.
+ */
+
+#define OSUX_HASH_INDEX_DIGEST_LENGTH 16
+
+typedef struct osux_hash_index_entry_ {
+    uint8_t digest[OSUX_HASH_INDEX_DIGEST_LENGTH];
+    uint32_t path_offset;
+} osux_hash_index_entry;
+
+/*
+ * Size and modification time (to the nanosecond) of the database file an
+ * index was built from: a sidecar is only used for that exact file.
+ */
+typedef struct osux_hash_index_source_ {
+    int64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+} osux_hash_index_source;
+
+typedef struct osux_hash_index_ {
+    osux_hash_index_source source; // saved in the sidecar header
+
+    uint32_t entry_count;
+    uint32_t entry_bufsize;
+    osux_hash_index_entry *entries;
+
+    uint32_t pool_size;
+    uint32_t pool_bufsize;
+    char *pool;
+} osux_hash_index;
+
+void osux_hash_index_init(osux_hash_index *index);
+void osux_hash_index_free(osux_hash_index *index);
+
+/* entries may be added in any order, then 'sort' must be called once */
+int osux_hash_index_add(osux_hash_index *index,
+                        char const *md5_hash, char const *path);
+int osux_hash_index_add_digest(
+    osux_hash_index *index,
+    uint8_t const digest[OSUX_HASH_INDEX_DIGEST_LENGTH], char const *path);
+void osux_hash_index_sort(osux_hash_index *index);
+
+/* the path is owned by the index; NULL when the hash is unknown */
+char const *osux_hash_index_lookup(osux_hash_index const *index,
+                                   char const *md5_hash);
+
+int osux_hash_index_save(osux_hash_index const *index, char const *path);
+int MUST_CHECK osux_hash_index_load(osux_hash_index *index, char const *path);
+
+/* parse a 32 characters hexadecimal md5 */
+bool osux_md5_hash_to_digest(char const *md5_hash,
+                             uint8_t digest[OSUX_HASH_INDEX_DIGEST_LENGTH]);
+
+G_END_DECLS
+
+#endif // OSUX_HASH_INDEX_H
@@ -1,6 +1,7 @@
 #ifndef OSUX_HIT_H
 #define OSUX_HIT_H
 
+#include <stdio.h>
 #include <string.h>
 #include <glib.h>
 
@@ -28,20 +29,39 @@ typedef enum osux_hit_type_ {
 struct osux_hit_ {
     osux_hit_type hit_type;
     bool hitted; // can be true even if hit_type == hit_miss
+    bool timed; // hit by a key press: 'distance' and 'key' are set
+    int64_t distance; // key press offset - hit object offset
+    uint32_t key;
+
+    // taiko
+    bool strong; // big note hit with both hands
+    unsigned bonus_hits; // drum roll ticks or shaker hits
+    unsigned bonus_max; // drum roll tick count or shaker hits required
 };
 
+/* judgement of a taiko object, in the order of taikorank's played_state */
+typedef enum osux_taiko_state_ {
+    OSUX_TAIKO_GREAT,
+    OSUX_TAIKO_GOOD,
+    OSUX_TAIKO_MISS,
+    OSUX_TAIKO_BONUS,
+} osux_taiko_state;
+
 typedef struct osux_keypress_ {
     int64_t offset;
     uint32_t key;
     bool release;
 } osux_keypress;
 
+/* gets the judgement trace line by line, without the trailing newline */
+typedef void (*osux_hits_debug_fn)(char const *line, void *user_data);
+
 typedef struct osux_hits_ {
     int game_mode;
     int mods;
-    int overall_difficulty;
+    double overall_difficulty;
 
-    osux_replay_data *data;
+    osux_replay_data *data; // NULL for OSUX_REPLAY_FRAME_COLUMNS replays
     size_t data_count;
 
     osux_keypress *keypress;
@@ -50,19 +70,59 @@ typedef struct osux_hits_ {
     /* public */
     osux_hit *hits;
     size_t hits_size;
+
+    unsigned hit_stats[MAX_HIT_TYPE];
+    double window[MAX_HIT_TYPE];
+    int64_t max_distance; // largest |distance| among the timed hits
+    double mean_error; // mean distance of the timed hits
+    double error_deviation; // standard deviation of the same
+    double unstable_rate; // 10 * error_deviation
+
+    osux_hits_debug_fn debug;
+    void *debug_data;
 } osux_hits;
 
+/* a (beatmap, replay) pair of osux_hits_compute_many */
+typedef struct osux_hits_job_ {
+    osux_beatmap const *beatmap;
+    osux_replay const *replay;
+    int err; // of osux_hits_init
+    osux_hits hits; // to be freed when err is 0
+} osux_hits_job;
+
 void osux_get_hit_windows(
     double window[], // Array of size MAX_HIT_TYPE to be filled by this function
     double od, // map overall difficulty
     int mods); // game mods, only EZ,HR,,HT,DT(or NC) have influence on hit window
+/* same for taiko: GREAT in window[HIT_300], GOOD in window[HIT_100] */
+void osux_get_taiko_hit_windows(double window[], double od, int mods);
 int osux_get_approach_time(double ar, int mods);
 
+/*
+ * Judge the replay against the beatmap; does not print anything and
+ * does not touch any global state, so that it can run in any thread.
+ */
 int osux_hits_init(osux_hits *hits,
                    osux_beatmap const *beatmap, osux_replay const *replay);
-void osux_hits_print_keypress(osux_hits *hits);
+/* same, with 'debug' (may be NULL) called for each line of the trace */
+int osux_hits_init_ex(osux_hits *hits,
+                      osux_beatmap const *beatmap, osux_replay const *replay,
+                      osux_hits_debug_fn debug, void *user_data);
+/* osux_hits_debug_fn writing to the FILE* 'user_data' */
+void osux_hits_print_debug(char const *line, void *user_data);
+void osux_hits_print_keypress(osux_hits const *hits, FILE *f);
 int osux_hits_free(osux_hits *hits);
 
+/*
+ * state of each hit object of a taiko judgement, into 'states'
+ * (beatmap->hitobject_count elements)
+ */
+int osux_hits_taiko_states(osux_hits const *hits, osux_beatmap const *beatmap,
+                           osux_taiko_state *states);
+
+/* run osux_hits_init on every job, on all processors */
+int osux_hits_compute_many(osux_hits_job *jobs, size_t count);
+
 G_END_DECLS
 
 #endif // OSUX_HIT_H
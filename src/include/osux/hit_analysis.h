@@ -0,0 +1,94 @@
+#ifndef OSUX_HIT_ANALYSIS_H
+#define OSUX_HIT_ANALYSIS_H
+
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <glib.h>
+
+#include "osux/hit.h"
+#include "osux/beatmap.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Timing error (key press offset - hit object offset) statistics,
+ * updated one error at a time (Welford's method).
+ */
+typedef struct osux_error_stats_ {
+    uint64_t count;
+    double mean;
+    double m2; // sum of the squared differences with the mean
+    int64_t min;
+    int64_t max;
+} osux_error_stats;
+
+void osux_error_stats_init(osux_error_stats *stats);
+void osux_error_stats_add(osux_error_stats *stats, int64_t error);
+/* population standard deviation, 0 without any error */
+double osux_error_stats_deviation(osux_error_stats const *stats);
+
+#define OSUX_UNSTABLE_RATE(deviation) (10. * (deviation))
+
+// default length of the sections, in milliseconds
+#define OSUX_HIT_ANALYSIS_SECTION_LENGTH 10000
+// key bits of the replay frames that can judge a hit object (keys.h)
+#define OSUX_HIT_ANALYSIS_KEY_COUNT 4
+
+typedef struct osux_bpm_stats_ {
+    double bpm;
+    osux_error_stats stats;
+} osux_bpm_stats;
+
+/*
+ * Timing errors of the timed hits of an osux_hits, grouped several ways;
+ * all of it is computed in a single pass over the hits.
+ */
+typedef struct osux_hit_analysis_ {
+    int game_mode;
+    osux_error_stats total;
+    double unstable_rate;
+
+    // section i holds the hit objects in [i, i+1) * section_length
+    int64_t section_length;
+    size_t section_count;
+    osux_error_stats *sections;
+
+    size_t bpm_count;
+    osux_bpm_stats *bpms; // by increasing bpm
+
+    osux_error_stats keys[OSUX_HIT_ANALYSIS_KEY_COUNT]; // by key bit
+    osux_error_stats left;
+    osux_error_stats right;
+    osux_error_stats don; // taiko only
+    osux_error_stats kat; // taiko only
+} osux_hit_analysis;
+
+/*
+ * 'hits' must come from 'beatmap';
+ * section_length <= 0 selects OSUX_HIT_ANALYSIS_SECTION_LENGTH
+ */
+int osux_hit_analysis_init(osux_hit_analysis *analysis,
+                           osux_hits const *hits, osux_beatmap const *beatmap,
+                           int64_t section_length);
+void osux_hit_analysis_free(osux_hit_analysis *analysis);
+void osux_hit_analysis_print(osux_hit_analysis const *analysis, FILE *f);
+
+G_END_DECLS
+
+#endif // OSUX_HIT_ANALYSIS_H
@@ -117,6 +117,9 @@ typedef struct osux_hitobject_ {
     osux_hitsound hitsound;
 
     osux_timingpoint const *timingpoint;
+    // cached from 'timingpoint' by osux_hitobject_prepare
+    double bpm;
+    double slider_velocity;
     uint32_t _osu_version;
 
     char *details;
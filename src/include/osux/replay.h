@@ -29,6 +29,7 @@ typedef struct osux_replay_ osux_replay;
 
 #include "osux/beatmap.h"
 #include "osux/hit.h"
+#include "osux/replay_frames.h"
 
 G_BEGIN_DECLS
 
@@ -81,9 +82,44 @@ struct osux_replay_ {
 
     uint64_t data_count;
     osux_replay_data *data;
+
+    /* same frames by column, with OSUX_REPLAY_FRAME_COLUMNS */
+    osux_replay_frames frames;
+
+    /* replays since 2013 end with a "-12345|0|0|<seed>" frame: its keys
+       are the seed, kept here; the frame itself is stored with no key */
+    uint32_t rng_seed;
 };
 
+#define OSUX_REPLAY_SEED_FRAME_TIME (-12345)
+
 int osux_replay_init(osux_replay *r, char const *file_path);
+
+enum osux_replay_init_flags {
+    // leave 'life' empty
+    OSUX_REPLAY_SKIP_LIFE_GRAPH = 1 << 0,
+    // leave 'data' empty; only the header is read from the file
+    OSUX_REPLAY_SKIP_FRAMES = 1 << 1,
+    // fill 'frames' instead of 'data'
+    OSUX_REPLAY_FRAME_COLUMNS = 1 << 2,
+};
+#define OSUX_REPLAY_HEADER_ONLY                                 \
+    (OSUX_REPLAY_SKIP_LIFE_GRAPH | OSUX_REPLAY_SKIP_FRAMES)
+
+int osux_replay_init_ex(osux_replay *r, char const *file_path, int flags);
+
+/*
+ * Load all the .osr files of a directory (not recursively) with a pool of
+ * worker threads, with 'osux_replay_init_ex' and 'flags'.
+ * 'callback' is always called from the calling thread, once per file,
+ * in completion order. 'replay' is NULL when 'err' is negative, and is
+ * freed when the callback returns (see osux_replay_move).
+ */
+typedef void (*osux_replay_scan_fn)(
+    osux_replay *replay, char const *path, int err, void *user_data);
+
+int osux_replay_scan(char const *dir_path, int flags,
+                     osux_replay_scan_fn callback, void *user_data);
 void osux_replay_print(osux_replay const *r, FILE *f);
 void osux_replay_free(osux_replay *r);
 void osux_replay_move(osux_replay *src, osux_replay *dst);
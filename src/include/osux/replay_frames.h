@@ -0,0 +1,81 @@
+#ifndef OSUX_REPLAY_FRAMES_H
+#define OSUX_REPLAY_FRAMES_H
+
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdint.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Replay frames stored by column: 14 bytes per frame instead of the 40
+ * of osux_replay_data, and passes over one column (keys for key presses,
+ * times for cursor lookups) only touch that column.
+ *
+ * Times are stored as the delta with the previous frame (previous_time
+ * in osux_replay_data); the absolute time (time_offset) of every
+ * OSUX_REPLAY_FRAMES_CHECKPOINT-th frame is kept so that any time is
+ * at most that many additions away.
+ */
+
+#define OSUX_REPLAY_FRAMES_CHECKPOINT 64
+
+typedef struct osux_replay_frames_ {
+    uint64_t count;
+    uint64_t capacity;
+
+    int32_t *delta;
+    float *x;
+    float *y;
+    uint16_t *keys;
+    int64_t *checkpoints; // time of frame i * OSUX_REPLAY_FRAMES_CHECKPOINT
+} osux_replay_frames;
+
+void osux_replay_frames_init(osux_replay_frames *frames);
+void osux_replay_frames_free(osux_replay_frames *frames);
+
+/* -OSUX_ERR_REPLAY_DATA when a value does not fit its column */
+int osux_replay_frames_append(osux_replay_frames *frames, int64_t previous_time,
+                              double x, double y, uint32_t keys);
+/* release the memory reserved for appending */
+void osux_replay_frames_shrink(osux_replay_frames *frames);
+
+/* time_offset of the frame 'i' (the first frame is at 0) */
+static inline int64_t
+osux_replay_frames_time_at(osux_replay_frames const *frames, uint64_t i)
+{
+    uint64_t c = i / OSUX_REPLAY_FRAMES_CHECKPOINT;
+    int64_t time = frames->checkpoints[c];
+    for (uint64_t k = c * OSUX_REPLAY_FRAMES_CHECKPOINT + 1; k <= i; ++k)
+        time += frames->delta[k];
+    return time;
+}
+
+/* times of the frames [first, first + count) into 'times' */
+void osux_replay_frames_times(osux_replay_frames const *frames,
+                              uint64_t first, uint64_t count, int64_t *times);
+
+/*
+ * last frame at or before 'time', 0 when there is none;
+ * frame times must be non decreasing
+ */
+uint64_t osux_replay_frames_find(osux_replay_frames const *frames, int64_t time);
+
+G_END_DECLS
+
+#endif // OSUX_REPLAY_FRAMES_H
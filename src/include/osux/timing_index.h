@@ -0,0 +1,63 @@
+#ifndef OSUX_TIMING_INDEX_H
+#define OSUX_TIMING_INDEX_H
+
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdint.h>
+#include <glib.h>
+
+#include "osux/timingpoint.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Answer "which timing point applies at time t" in O(log n).
+ *
+ * The index holds pointers into a timing point array, sorted by offset
+ * (points sharing an offset keep their array order, the last one wins).
+ * It must be rebuilt whenever the array is modified or reallocated;
+ * osux_beatmap_prepare does it for the beatmap's own index.
+ *
+ * Times before the first point resolve to the first point, like the
+ * in-order walks this replaces. Lookups return NULL only when there is
+ * no point of the requested kind at all.
+ */
+
+typedef struct osux_timing_index_ {
+    uint32_t point_count;
+    osux_timingpoint const **points;
+
+    uint32_t uninherited_count;
+    osux_timingpoint const **uninherited;
+} osux_timing_index;
+
+void osux_timing_index_init(osux_timing_index *index,
+                            osux_timingpoint const *timingpoints,
+                            uint32_t timingpoint_count);
+void osux_timing_index_free(osux_timing_index *index);
+
+/* the point in effect at 'offset', inherited or not */
+osux_timingpoint const *
+osux_timing_index_lookup(osux_timing_index const *index, double offset);
+
+/* the point giving the beat length at 'offset' */
+osux_timingpoint const *
+osux_timing_index_uninherited_at(osux_timing_index const *index, double offset);
+
+G_END_DECLS
+
+#endif // OSUX_TIMING_INDEX_H
@@ -7,7 +7,42 @@
 
 G_BEGIN_DECLS
 
-void lzma_decompress(uint8_t *in_buf, size_t in_isze,
+/*
+ * Decoder for the .lzma (LZMA-alone) streams of replay files.
+ * A decoder can be reused for any number of streams, which saves
+ * reallocating its dictionary each time; it is not thread safe.
+ */
+typedef struct osux_lzma_decoder_ osux_lzma_decoder;
+
+osux_lzma_decoder *osux_lzma_decoder_new(void);
+void osux_lzma_decoder_free(osux_lzma_decoder *dec);
+
+/*
+ * Decompress 'in' into *buf, which is grown (g_realloc) when smaller than
+ * needed; *buf and *buf_size may be reused across calls.
+ * The output is null terminated, *out_len does not count the null byte.
+ */
+int osux_lzma_decoder_decode(osux_lzma_decoder *dec,
+                             uint8_t const *in, size_t in_size,
+                             uint8_t **buf, size_t *buf_size, size_t *out_len);
+
+/*
+ * Decompress 'in' through a fixed size window: 'callback' gets the output
+ * chunk by chunk, in order; a negative return from it aborts decoding
+ * and is returned.
+ */
+typedef int (*osux_lzma_chunk_fn)(uint8_t const *chunk, size_t size,
+                                  void *user_data);
+int osux_lzma_decoder_decode_chunks(osux_lzma_decoder *dec,
+                                    uint8_t const *in, size_t in_size,
+                                    osux_lzma_chunk_fn callback,
+                                    void *user_data);
+
+/* a decoder owned by the calling thread, freed when the thread exits */
+osux_lzma_decoder *osux_lzma_thread_decoder(void);
+
+/* *out_buf is NULL on error, g_free it otherwise */
+void lzma_decompress(uint8_t const *in_buf, size_t in_size,
                      uint8_t **out_buf, size_t *out_len);
 G_END_DECLS
 
@@ -13,6 +13,7 @@
 #include "osux/util.h"
 #include "osux/hitsound.h"
 #include "osux/mods.h"
+#include "field_cursor.h"
 
 int osux_beatmap_free(osux_beatmap *beatmap)
 {
@@ -47,6 +48,7 @@ int osux_beatmap_free(osux_beatmap *beatmap)
     g_free(beatmap->events);
     g_free(beatmap->hitobjects);
     g_free(beatmap->timingpoints);
+    osux_timing_index_free(&beatmap->timing_index);
 
     if (beatmap->sections != NULL)
         osux_hashtable_delete(beatmap->sections);
@@ -75,8 +77,8 @@ static int parse_osu_version(osux_beatmap *beatmap, GIOChannel *file)
     if (err)
         return err;
 
-    if (regexp == NULL)
-        regexp = g_regex_new("format v([0-9]+)$", 0, 0, NULL);
+    if (g_once_init_enter(&regexp))
+        g_once_init_leave(&regexp, g_regex_new("format v([0-9]+)$", 0, 0, NULL));
 
     GMatchInfo *info = NULL;
     if (!g_regex_match(regexp, line, 0, &info)) {
@@ -118,46 +120,189 @@ static int compute_metadata(osux_beatmap *beatmap, GIOChannel *file)
     return 0;
 }
 
-static bool get_new_section(char const *line, char **section_name)
+/*
+ * Known options (the DEFAULT_VALUES list) are parsed straight into the
+ * beatmap while reading the file. Only unknown keys are kept, as strings,
+ * in 'beatmap->sections'.
+ */
+
+#define SECTION_LIST(SECTION)                   \
+    SECTION(General)                            \
+    SECTION(Editor)                             \
+    SECTION(Metadata)                           \
+    SECTION(Difficulty)                         \
+    SECTION(Events)                             \
+    SECTION(TimingPoints)                       \
+    SECTION(Colours)                            \
+    SECTION(HitObjects)                         \
+
+#define SECTION_TO_ENUM(section) SECTION_##section,
+#define SECTION_TO_NAME(section) [SECTION_##section] = #section,
+
+enum beatmap_section {
+    SECTION_NONE = 0, // before the first section header, or unknown section
+    SECTION_LIST(SECTION_TO_ENUM)
+    SECTION_COUNT,
+};
+
+static char const *section_names[SECTION_COUNT] = {
+    SECTION_LIST(SECTION_TO_NAME)
+};
+
+static int get_section_id(char const *name)
 {
-    static GRegex *regexp = NULL;
-    if (regexp == NULL)
-        regexp = g_regex_new("^\\[(.*)\\]$", 0, 0, NULL);
+    for (int i = SECTION_NONE + 1; i < SECTION_COUNT; ++i)
+        if (!strcmp(name, section_names[i]))
+            return i;
+    return SECTION_NONE;
+}
 
-    GMatchInfo *info = NULL;
-    if (!g_regex_match(regexp, line, 0, &info)) {
-        g_match_info_free(info);
+static bool get_new_section(char *line, char **section_name)
+{
+    size_t length = strlen(line);
+    if (length < 2 || line[0] != '[' || line[length-1] != ']')
         return false;
+
+    g_free(*section_name);
+    *section_name = g_strndup(line + 1, length - 2);
+    return true;
+}
+
+#define MATCH_SAMPLE_SET_(value_, caps_, pretty_)       \
+    do {                                                \
+        if (!g_strcmp0((pretty_), sample_set)) {        \
+            return (value_);                            \
+        }                                               \
+    } while (0);
+
+
+static int64_t parse_sample_set(gchar const *sample_set)
+{
+    SAMPLE_SETS(MATCH_SAMPLE_SET_);
+    return -1;
+}
+
+// conversions returning allocated memory must release the previous value
+// when a key is repeated (the last occurrence wins)
+#define OPTION_RELEASE_g_strdup(value_) g_free(value_)
+#define OPTION_RELEASE_atoi(value_)
+#define OPTION_RELEASE_osux_strtod(value_)
+#define OPTION_RELEASE_osux_tobool(value_)
+#define OPTION_RELEASE_parse_sample_set(value_)
+
+#define DEFINE_OPTION_SETTER(section, field, type, default_value, method) \
+    static void set_option_##field(osux_beatmap *beatmap, char *value)  \
+    {                                                                   \
+        OPTION_RELEASE_##method(beatmap->field);                        \
+        beatmap->field = method(value);                                 \
     }
 
-    if (g_match_info_matches(info)) {
-        g_free(*section_name);
-        *section_name = g_match_info_fetch(info, 1);
-        g_match_info_free(info);
-        return true;
+DEFAULT_VALUES(DEFINE_OPTION_SETTER)
+
+typedef struct option_field_ {
+    int section;
+    size_t key_length;
+    char const *key;
+    void (*set)(osux_beatmap *beatmap, char *value);
+} option_field;
+
+#define OPTION_FIELD(section, field, type, default_value, method)       \
+    { SECTION_##section, sizeof #field - 1, #field, &set_option_##field },
+
+static option_field const option_fields[] = {
+    DEFAULT_VALUES(OPTION_FIELD)
+};
+
+#define SET_DEFAULT_VALUE(section, field, type, default_value, method)  \
+    beatmap->field = (default_value);
+
+static void set_default_values(osux_beatmap *beatmap)
+{
+    DEFAULT_VALUES(SET_DEFAULT_VALUE)
+}
+
+static option_field const *
+find_option_field(int section, char const *key, size_t key_length)
+{
+    // the length test discards almost every entry without touching the key
+    for (unsigned i = 0; i < ARRAY_SIZE(option_fields); ++i) {
+        option_field const *f = &option_fields[i];
+        if (f->key_length == key_length && f->section == section &&
+            !memcmp(f->key, key, key_length))
+            return f;
     }
-    g_match_info_free(info);
-    return false;
+    return NULL;
+}
+
+/* options which need the whole file before being interpreted */
+typedef struct option_state_ {
+    bool has_section[SECTION_COUNT];
+    char *editor_bookmarks;  // [Editor] Bookmarks
+    char *general_bookmarks; // [General] EditorBookmarks
+    char *tags;              // [Metadata] Tags
+    osux_hashtable *overflow; // unknown keys of the current section
+    bool has_object;
+    int64_t first_offset;    // [HitObjects] earliest and latest offsets
+    int64_t last_offset;
+    int64_t break_time;      // [Events] sum of the break periods
+} option_state;
+
+static void option_state_free(option_state *st)
+{
+    g_free(st->editor_bookmarks);
+    g_free(st->general_bookmarks);
+    g_free(st->tags);
+}
+
+static void set_option_string(char **dst, char const *value)
+{
+    g_free(*dst);
+    *dst = g_strdup(value);
 }
 
-static int parse_option_entry(
-    char const *line, osux_hashtable *section)
+/* 'line' is modified in place */
+static int parse_option_entry(osux_beatmap *beatmap, option_state *st,
+                              int section, char const *section_name,
+                              char *line)
 {
-    char *sep = strstr(line, ":");
+    char *sep = strchr(line, ':');
     if (sep == NULL)
         return -OSUX_ERR_MALFORMED_OSU_FILE;
-    char **split = g_strsplit(line, ":", 2);
-    osux_hashtable_insert( section,
-                           g_strstrip(split[0]),
-                           g_strchug(g_strdup(split[1])) );
-    g_strfreev(split);
+
+    *sep = '\0';
+    char *key = g_strstrip(line);
+    char *value = g_strchug(sep + 1);
+    size_t key_length = strlen(key);
+
+    option_field const *f = find_option_field(section, key, key_length);
+    if (f != NULL) {
+        (*f->set)(beatmap, value);
+        return 0;
+    }
+
+    if (section == SECTION_Editor && !strcmp(key, "Bookmarks"))
+        set_option_string(&st->editor_bookmarks, value);
+    else if (section == SECTION_General && !strcmp(key, "EditorBookmarks"))
+        set_option_string(&st->general_bookmarks, value);
+    else if (section == SECTION_Metadata && !strcmp(key, "Tags"))
+        set_option_string(&st->tags, value);
+    else {
+        if (st->overflow == NULL) {
+            st->overflow = osux_hashtable_new_full(0, g_free);
+            osux_hashtable_insert(beatmap->sections,
+                                  section_name ? section_name : "",
+                                  st->overflow);
+        }
+        osux_hashtable_insert(st->overflow, key, g_strdup(value));
+    }
     return 0;
 }
 
 #define CHECK_OBJECT(r, s)                              \
     if ((r) < 0) {                                      \
         osux_error("%s line %d\n", s, line_count);      \
-        return r;                                       \
+        err = (r);                                      \
+        goto finally;                                   \
     }
 
 #define CHECK_COLOR(r, x)                                               \
@@ -237,15 +382,119 @@ static gint sort_color(osux_color *a, osux_color *b)
         UPDATE_STAT_BPM(beatmap, &(elem));                              \
     } while(0)
 
-static int parse_objects(osux_beatmap *beatmap, GIOChannel *file)
+static void fetch_bookmarks(osux_beatmap *beatmap, option_state const *st)
+{
+    char const *bookmarks;
+    if (st->has_section[SECTION_Editor])
+        bookmarks = st->editor_bookmarks;
+    else
+        bookmarks = st->general_bookmarks;
+
+    if (bookmarks == NULL)
+        return;
+
+    char **split = g_strsplit(bookmarks, ",", 0);
+    unsigned size = strsplit_size(split);
+    ALLOC_ARRAY(beatmap->bookmarks, beatmap->bookmark_bufsize, size);
+    beatmap->bookmark_count = size;
+    for (unsigned i = 0; i < size; ++i)
+        beatmap->bookmarks[i] = atoi(split[i]);
+    g_strfreev(split);
+}
+
+static void fetch_tags(osux_beatmap *beatmap, option_state const *st)
+{
+    if (!st->has_section[SECTION_Metadata])
+        return;
+
+    beatmap->tags_orig = g_strdup(st->tags != NULL ? st->tags : "");
+    if (st->tags != NULL) {
+        beatmap->tags = g_strsplit(st->tags, " ", 0);
+        beatmap->tag_count = strsplit_size(beatmap->tags);
+    }
+}
+
+static void update_object_time(option_state *st, int64_t offset)
+{
+    if (!st->has_object) {
+        st->has_object = true;
+        st->first_offset = offset;
+        st->last_offset = offset;
+    } else {
+        st->first_offset = MIN(st->first_offset, offset);
+        st->last_offset = MAX(st->last_offset, offset);
+    }
+}
+
+/*
+ * total time: up to the last hit object start,
+ * drain time: from the first hit object start to the last one, minus
+ * the break periods
+ */
+static void fetch_object_time(osux_beatmap *beatmap, option_state const *st)
+{
+    if (!st->has_object)
+        return;
+    beatmap->total_time = st->last_offset;
+    beatmap->drain_time = MAX(0, st->last_offset - st->first_offset
+                              - st->break_time);
+}
+
+// 2,start,end (or Break,start,end): break periods are top level objects
+static void count_break(option_state *st, char const *line)
+{
+    osux_field_cursor c;
+    osux_field f = osux_field_from_string(line);
+
+    osux_field_cursor_init(&c, &f);
+    if (!osux_field_next(&c, ',', &f))
+        return;
+    size_t len = f.end - f.begin;
+    if (!((len == 1 && f.begin[0] == '2') ||
+          (len == 5 && !strncmp(f.begin, "Break", 5))))
+        return;
+    if (!osux_field_next(&c, ',', &f))
+        return;
+    int64_t start = osux_field_to_int64(&f);
+    if (!osux_field_next(&c, ',', &f))
+        return;
+    int64_t end = osux_field_to_int64(&f);
+    if (end > start)
+        st->break_time += end - start;
+}
+
+// x,y,offset,type,...: only the offset and type are needed for the statistics
+static void count_hitobject(osux_beatmap *beatmap, option_state *st,
+                            char const *line)
+{
+    osux_field_cursor c;
+    osux_field f = osux_field_from_string(line);
+
+    osux_field_cursor_init(&c, &f);
+    for (int i = 0; i < 3; ++i)
+        if (!osux_field_next(&c, ',', &f))
+            return;
+    int64_t offset = osux_field_to_int64(&f);
+    if (!osux_field_next(&c, ',', &f))
+        return;
+    osux_hitobject ho = { .type = osux_field_to_int(&f) };
+    UPDATE_STAT_HO_COUNT(beatmap, &ho);
+    update_object_time(st, offset);
+}
+
+static int parse_objects(osux_beatmap *beatmap, GIOChannel *file,
+                         bool metadata_only)
 {
     int err = 0;
-    osux_hashtable *current_section = NULL;
+    int section = SECTION_NONE;
     char *section_name = NULL;
+    option_state st;
+    memset(&st, 0, sizeof st);
 
     beatmap->bpm_min = DBL_MAX;
     beatmap->sections = osux_hashtable_new_full(
         0, (void(*)(void*)) &osux_hashtable_delete);
+    set_default_values(beatmap);
 
     ALLOC_ARRAY(beatmap->hitobjects, beatmap->hitobject_bufsize, 500);
     ALLOC_ARRAY(beatmap->timingpoints, beatmap->timingpoint_bufsize, 500);
@@ -254,115 +503,61 @@ static int parse_objects(osux_beatmap *beatmap, GIOChannel *file)
 
     char *line = NULL;
     int line_count = 0;
-    for (line = NULL; (err = osux_getline(file, &line))==0; g_free(line)) {
+    for (line = NULL; (err = osux_getline(file, &line))==0; g_clear_pointer(&line, g_free)) {
         ++ line_count;
         if (line_is_empty_or_comment(line))
             continue;
 
         if (get_new_section(line, &section_name)) {
-            current_section = osux_hashtable_new_full(0, g_free);
-            osux_hashtable_insert(
-                beatmap->sections, section_name, current_section);
-            //printf("section='%s'\n", section_name);
-        } else if (!strcmp(section_name, "TimingPoints"))
+            section = get_section_id(section_name);
+            st.has_section[section] = true;
+            st.overflow = NULL;
+            continue;
+        }
+
+        switch (section) {
+        case SECTION_TimingPoints:
             ARRAY_APPEND(beatmap->timingpoint, TIMINGPOINT_INIT,
                          line, beatmap->osu_version, beatmap);
-        else if (!strcmp(section_name, "HitObjects"))
-            ARRAY_APPEND(beatmap->hitobject, HITOBJECT_INIT,
-                         line, beatmap->osu_version, beatmap);
-        else if (!strcmp(section_name, "Events"))
-            ARRAY_APPEND(beatmap->event, EVENT_INIT, line, beatmap->osu_version);
-        else if (!strcmp(section_name, "Colours"))
-            ARRAY_APPEND(beatmap->color, COLOR_INIT,
-                         line, beatmap->osu_version, beatmap);
-        else
-            parse_option_entry(line, current_section);
-    }
-    g_free(section_name);
-    if (err == 1) err = 0;
-    return err;
-}
-
-#define FETCH( section, field, type, default_value, method )            \
-    do {                                                                \
-        osux_hashtable *section_ = NULL;                                \
-        if (osux_hashtable_lookup(beatmap->sections, #section, &section_) < 0) { \
-            /*osux_debug("No section '%s'\n", #section);*/              \
-            beatmap->field = (default_value);                           \
-            break;                                                      \
-        }                                                               \
-                                                                        \
-        char *str_ = NULL;                                              \
-        if (osux_hashtable_lookup(section_, #field, &str_) < 0) {       \
-            beatmap->field = (default_value);                           \
-        } else {                                                        \
-            beatmap->field = method(str_);                              \
-        }                                                               \
-    } while (0);
-
-
-static void fetch_bookmarks(osux_beatmap *beatmap)
-{
-    osux_hashtable *section = NULL;
-    char *bookmarks = NULL;
-    osux_hashtable_lookup(beatmap->sections, "Editor", &section);
-    if (section != NULL) {
-        osux_hashtable_lookup(section, "Bookmarks", &bookmarks);
-    } else {
-        osux_hashtable_lookup(beatmap->sections, "General", &section);
-        if (section != NULL)
-            osux_hashtable_lookup(section, "EditorBookmarks", &bookmarks);
-    }
-
-    if (bookmarks == NULL)
-        return;
-
-    char **split = g_strsplit(bookmarks, ",", 0);
-    unsigned size = strsplit_size(split);
-    ALLOC_ARRAY(beatmap->bookmarks, beatmap->bookmark_bufsize, size);
-    beatmap->bookmark_count = size;
-    for (unsigned i = 0; i < size; ++i)
-        beatmap->bookmarks[i] = atoi(split[i]);
-    g_strfreev(split);
-}
-
-static void fetch_tags(osux_beatmap *beatmap)
-{
-    osux_hashtable *section = NULL;
-    char *tags = NULL;
-    osux_hashtable_lookup(beatmap->sections, "Metadata", &section);
-    if (section != NULL) {
-        osux_hashtable_lookup(section, "Tags", &tags);
-        beatmap->tags_orig = g_strdup("");
-        if (tags != NULL) {
-            g_free(beatmap->tags_orig);
-            beatmap->tags_orig = g_strdup(tags);
-            beatmap->tags = g_strsplit(tags, " ", 0);
-            beatmap->tag_count = strsplit_size(beatmap->tags);
+            break;
+        case SECTION_HitObjects:
+            if (metadata_only) {
+                count_hitobject(beatmap, &st, line);
+            } else {
+                ARRAY_APPEND(beatmap->hitobject, HITOBJECT_INIT,
+                             line, beatmap->osu_version, beatmap);
+                update_object_time(&st, beatmap->hitobjects[
+                    beatmap->hitobject_count - 1].offset);
+            }
+            break;
+        case SECTION_Events:
+            count_break(&st, line);
+            if (!metadata_only)
+                ARRAY_APPEND(beatmap->event, EVENT_INIT,
+                             line, beatmap->osu_version);
+            break;
+        case SECTION_Colours:
+            if (!metadata_only)
+                ARRAY_APPEND(beatmap->color, COLOR_INIT,
+                             line, beatmap->osu_version, beatmap);
+            break;
+        default:
+            parse_option_entry(beatmap, &st, section, section_name, line);
+            break;
         }
     }
-}
-
-#define MATCH_SAMPLE_SET_(value_, caps_, pretty_)       \
-    do {                                                \
-        if (!g_strcmp0((pretty_), sample_set)) {        \
-            return (value_);                            \
-        }                                               \
-    } while (0);
-
-
-static int64_t parse_sample_set(gchar const *sample_set)
-{
-    SAMPLE_SETS(MATCH_SAMPLE_SET_);
-    return -1;
-}
+    if (err == 1) {
+        err = 0;
+        fetch_bookmarks(beatmap, &st);
+        fetch_tags(beatmap, &st);
+        fetch_object_time(beatmap, &st);
+    }
 
-static int fetch_variables(osux_beatmap *beatmap)
-{
-    DEFAULT_VALUES(FETCH);
-    fetch_bookmarks(beatmap);
-    fetch_tags(beatmap);
-    return 0;
+finally:
+    g_free(line);
+    option_state_free(&st);
+    g_free(section_name);
+    return err;
 }
 
 static void
@@ -416,22 +611,17 @@ osux_combo_colour(osux_combo *combo)
 static int prepare_hitobjects(osux_beatmap *beatmap)
 {
     int err = 0;
-    uint32_t current_tp = 0;
     osux_combo combo;
     osux_combo_init(&combo, beatmap);
 
     for (uint32_t i = 0; !err && i < beatmap->hitobject_count; ++i) {
 	osux_hitobject *ho = &beatmap->hitobjects[i];
-        // for each hit object
-        // compute timing point applying on this hit object
-	while (current_tp < (beatmap->timingpoint_count-1) &&
-	       beatmap->timingpoints[current_tp + 1].offset <= ho->offset)
-	    current_tp++;
+        osux_timingpoint const *tp;
+        tp = osux_timing_index_lookup(&beatmap->timing_index, ho->offset);
 
         osux_combo_next(&combo, ho);
 	err = osux_hitobject_prepare(ho, combo.id, combo.pos,
-                                     osux_combo_colour(&combo),
-                                     &beatmap->timingpoints[current_tp]);
+                                     osux_combo_colour(&combo), tp);
     }
     return err;
 }
@@ -446,6 +636,9 @@ int osux_beatmap_prepare(osux_beatmap *beatmap)
                                        &last_non_inherited,
                                        beatmap->SliderMultiplier);
     }
+    osux_timing_index_free(&beatmap->timing_index);
+    osux_timing_index_init(&beatmap->timing_index, beatmap->timingpoints,
+                           beatmap->timingpoint_count);
     prepare_colors(beatmap);
     err = prepare_hitobjects(beatmap);
 
@@ -461,7 +654,8 @@ int osux_beatmap_prepare(osux_beatmap *beatmap)
     return err;
 }
 
-int osux_beatmap_init(osux_beatmap *beatmap, char const *file_path)
+static int beatmap_init(osux_beatmap *beatmap, char const *file_path,
+                        bool metadata_only)
 {
     int err = 0;
     memset(beatmap, 0, sizeof *beatmap);
@@ -478,16 +672,14 @@ int osux_beatmap_init(osux_beatmap *beatmap, char const *file_path)
         return err;
     }
 
-    if ((err = parse_objects(beatmap, file)) < 0) {
+    if ((err = parse_objects(beatmap, file, metadata_only)) < 0) {
         osux_beatmap_free(beatmap);
         return err;
     }
     g_io_channel_unref(file);
     file = NULL;
-    if ((err = fetch_variables(beatmap)) < 0) {
-        osux_beatmap_free(beatmap);
-        return err;
-    }
+    if (metadata_only)
+        return 0;
     if ((err = osux_beatmap_prepare(beatmap)) < 0) {
         osux_beatmap_free(beatmap);
         return err;
@@ -495,6 +687,16 @@ int osux_beatmap_init(osux_beatmap *beatmap, char const *file_path)
     return 0;
 }
 
+int osux_beatmap_init(osux_beatmap *beatmap, char const *file_path)
+{
+    return beatmap_init(beatmap, file_path, false);
+}
+
+int osux_beatmap_init_metadata(osux_beatmap *beatmap, char const *file_path)
+{
+    return beatmap_init(beatmap, file_path, true);
+}
+
 void osux_beatmap_append_hitobject(osux_beatmap *beatmap, osux_hitobject *ho)
 {
     HANDLE_ARRAY_SIZE(beatmap->hitobjects,
@@ -504,6 +706,21 @@ void osux_beatmap_append_hitobject(osux_beatmap *beatmap, osux_hitobject *ho)
     UPDATE_STAT_HO_COUNT(
         beatmap, &beatmap->hitobjects[beatmap->hitobject_count]);
     ++ beatmap->hitobject_count;
+
+    int64_t offset = beatmap->hitobjects[beatmap->hitobject_count - 1].offset;
+    option_state st = {
+        .has_object = true,
+        .first_offset = MIN(beatmap->hitobjects[0].offset, offset),
+        .last_offset = beatmap->hitobject_count > 1 ?
+                       MAX(beatmap->total_time, offset) : offset,
+    };
+    for (unsigned i = 0; i < beatmap->event_count; ++i) {
+        osux_event const *ev = &beatmap->events[i];
+        if (EVENT_IS_OBJECT(ev) && ev->type == EVENT_OBJECT_BREAK &&
+            ev->end_offset > ev->offset)
+            st.break_time += ev->end_offset - ev->offset;
+    }
+    fetch_object_time(beatmap, &st);
 }
 
 void osux_beatmap_append_timingpoint(osux_beatmap *beatmap, osux_timingpoint *tp)
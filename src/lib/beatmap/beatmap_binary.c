@@ -0,0 +1,699 @@
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "osux/beatmap.h"
+#include "osux/error.h"
+#include "osux/util.h"
+
+/*
+ * .osub layout:
+ *   header (magic, version, record sizes, section table, raw beatmap struct)
+ *   one section per flat array, each 8-byte aligned
+ *
+ * Every pointer stored in a record is replaced by a reference:
+ * 0 for NULL, otherwise index + 1 in the section it points to
+ * (byte offset + 1 in the string pool for strings).
+ * The record sizes are part of the header so a file written by a build
+ * with a different struct layout is rejected instead of misread.
+ */
+
+#define OSUB_MAGIC "OSUB"
+#define OSUB_VERSION 4
+#define OSUB_BYTE_ORDER 0x01020304
+#define OSUB_ALIGN 8
+
+enum osub_section_id {
+    OSUB_HITOBJECTS,
+    OSUB_TIMINGPOINTS,
+    OSUB_EVENTS,
+    OSUB_COMMANDS, // chained event commands (osux_event_command.next)
+    OSUB_COLORS,
+    OSUB_BOOKMARKS,
+    OSUB_TAGS,
+    OSUB_POINTS,
+    OSUB_EDGEHITSOUNDS,
+    OSUB_STRINGS,
+    OSUB_SECTION_COUNT,
+};
+
+static size_t const osub_record_size[OSUB_SECTION_COUNT] = {
+    [OSUB_HITOBJECTS] = sizeof(osux_hitobject),
+    [OSUB_TIMINGPOINTS] = sizeof(osux_timingpoint),
+    [OSUB_EVENTS] = sizeof(osux_event),
+    [OSUB_COMMANDS] = sizeof(osux_event_command),
+    [OSUB_COLORS] = sizeof(osux_color),
+    [OSUB_BOOKMARKS] = sizeof(int64_t),
+    [OSUB_TAGS] = sizeof(uint64_t),
+    [OSUB_POINTS] = sizeof(osux_point),
+    [OSUB_EDGEHITSOUNDS] = sizeof(osux_edgehitsound),
+    [OSUB_STRINGS] = 1,
+};
+
+typedef struct osub_section_ {
+    uint64_t offset;
+    uint64_t count;
+} osub_section;
+
+typedef struct osub_header_ {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t beatmap_size;
+    uint32_t record_size[OSUB_SECTION_COUNT];
+    osub_section sections[OSUB_SECTION_COUNT];
+    osux_beatmap beatmap;
+} osub_header;
+
+#define TO_REF(type_, ref_) ((type_) (uintptr_t) (ref_))
+#define FROM_REF(ptr_) ((uint64_t) (uintptr_t) (ptr_))
+#define ALIGN_UP(x_) (((x_) + OSUB_ALIGN - 1) & ~(uint64_t) (OSUB_ALIGN - 1))
+
+/* ------------------------------------------------------------------------ */
+/* writer */
+
+typedef struct osub_writer_ {
+    GArray *sections[OSUB_SECTION_COUNT];
+} osub_writer;
+
+static uint64_t add_records(osub_writer *w, int id,
+                            void const *data, uint64_t count)
+{
+    if (data == NULL || count == 0)
+        return 0;
+    uint64_t index = w->sections[id]->len;
+    g_array_append_vals(w->sections[id], data, count);
+    return index + 1;
+}
+
+static uint64_t add_string(osub_writer *w, char const *str)
+{
+    if (str == NULL)
+        return 0;
+    return add_records(w, OSUB_STRINGS, str, strlen(str) + 1);
+}
+
+static void write_hitobject(osub_writer *w, osux_beatmap const *bm,
+                            osux_hitobject const *ho)
+{
+    osux_hitobject rec = *ho;
+    osux_slider const *sl = &ho->slider;
+
+    rec.combo_color = NULL;
+    if (ho->combo_color != NULL)
+        rec.combo_color = TO_REF(osux_color*, ho->combo_color - bm->colors + 1);
+    rec.timingpoint = NULL;
+    if (ho->timingpoint != NULL)
+        rec.timingpoint = TO_REF(osux_timingpoint const*,
+                                 ho->timingpoint - bm->timingpoints + 1);
+
+    rec.slider.points = TO_REF(osux_point*, add_records(
+        w, OSUB_POINTS, sl->points, sl->point_count));
+    rec.slider.edgehitsounds = NULL;
+    if (sl->edgehitsounds != NULL)
+        rec.slider.edgehitsounds = TO_REF(osux_edgehitsound*, add_records(
+            w, OSUB_EDGEHITSOUNDS, sl->edgehitsounds, sl->repeat + 1));
+
+    rec.hitsound.sfx_filename = TO_REF(char*, add_string(
+        w, ho->hitsound.sfx_filename));
+    rec.details = TO_REF(char*, add_string(w, ho->details));
+    rec.errmsg = TO_REF(char*, add_string(w, ho->errmsg));
+    rec.data = NULL;
+    rec.free_data = NULL;
+    g_array_append_val(w->sections[OSUB_HITOBJECTS], rec);
+}
+
+static void write_timingpoint(osub_writer *w, osux_beatmap const *bm,
+                              osux_timingpoint const *tp)
+{
+    osux_timingpoint rec = *tp;
+
+    rec.last_non_inherited = NULL;
+    if (tp->last_non_inherited != NULL)
+        rec.last_non_inherited = TO_REF(
+            osux_timingpoint const*,
+            tp->last_non_inherited - bm->timingpoints + 1);
+    rec.details = TO_REF(char*, add_string(w, tp->details));
+    rec.errmsg = TO_REF(char*, add_string(w, tp->errmsg));
+    g_array_append_val(w->sections[OSUB_TIMINGPOINTS], rec);
+}
+
+// the chain is written tail first so each record knows its successor
+static uint64_t write_command_chain(osub_writer *w,
+                                    osux_event_command const *cmd)
+{
+    if (cmd == NULL)
+        return 0;
+    osux_event_command rec = *cmd;
+    rec.next = TO_REF(osux_event_command*, write_command_chain(w, cmd->next));
+    rec.trigger = TO_REF(char*, add_string(w, cmd->trigger));
+    return add_records(w, OSUB_COMMANDS, &rec, 1);
+}
+
+static void write_event(osub_writer *w, osux_event const *ev)
+{
+    osux_event rec = *ev;
+
+    if (EVENT_IS_COMMAND(ev)) {
+        rec.command.next = TO_REF(osux_event_command*,
+                                  write_command_chain(w, ev->command.next));
+        rec.command.trigger = TO_REF(char*, add_string(w, ev->command.trigger));
+    } else
+        rec.object.filename = TO_REF(char*, add_string(w, ev->object.filename));
+
+    // the tree is rebuilt from the levels when loading
+    rec.parent = NULL;
+    rec.childs = NULL;
+    rec.child_count = 0;
+    rec.child_bufsize = 0;
+    g_array_append_val(w->sections[OSUB_EVENTS], rec);
+}
+
+static void write_beatmap(osub_writer *w, osux_beatmap const *bm,
+                          osux_beatmap *rec)
+{
+    *rec = *bm;
+
+    #define STRING_REF(field_)                                          \
+        rec->field_ = TO_REF(char*, add_string(w, bm->field_))
+
+    STRING_REF(md5_hash);
+    STRING_REF(osu_filename);
+    STRING_REF(file_path);
+    STRING_REF(AudioFilename);
+    STRING_REF(Title);
+    STRING_REF(TitleUnicode);
+    STRING_REF(Artist);
+    STRING_REF(ArtistUnicode);
+    STRING_REF(Creator);
+    STRING_REF(Version);
+    STRING_REF(Source);
+    STRING_REF(Tags);
+
+    #undef STRING_REF
+
+    rec->bookmarks = TO_REF(int64_t*, add_records(
+        w, OSUB_BOOKMARKS, bm->bookmarks, bm->bookmark_count));
+    rec->bookmark_bufsize = bm->bookmark_count;
+
+    rec->tags = NULL;
+    if (bm->tags != NULL) {
+        uint64_t tag_count = g_strv_length(bm->tags);
+        uint64_t *refs = g_new(uint64_t, tag_count + 1);
+        for (uint64_t i = 0; i < tag_count; ++i)
+            refs[i] = add_string(w, bm->tags[i]);
+        refs[tag_count] = 0;
+        rec->tags = TO_REF(char**, add_records(
+            w, OSUB_TAGS, refs, tag_count + 1));
+        g_free(refs);
+    }
+
+    rec->colors = TO_REF(osux_color*, add_records(
+        w, OSUB_COLORS, bm->colors, bm->color_count));
+    rec->color_bufsize = bm->color_count;
+    rec->combo_colours = NULL;
+
+    for (unsigned i = 0; i < bm->timingpoint_count; ++i)
+        write_timingpoint(w, bm, &bm->timingpoints[i]);
+    rec->timingpoint_bufsize = bm->timingpoint_count;
+    rec->timingpoints = NULL;
+    memset(&rec->timing_index, 0, sizeof rec->timing_index);
+
+    for (unsigned i = 0; i < bm->hitobject_count; ++i)
+        write_hitobject(w, bm, &bm->hitobjects[i]);
+    rec->hitobject_bufsize = bm->hitobject_count;
+    rec->hitobjects = NULL;
+
+    for (unsigned i = 0; i < bm->event_count; ++i)
+        write_event(w, &bm->events[i]);
+    rec->event_bufsize = bm->event_count;
+    rec->events = NULL;
+
+    rec->sections = NULL;
+    rec->h_data = NULL;
+    rec->data = NULL;
+}
+
+int osux_beatmap_save_binary(osux_beatmap const *beatmap, char const *path)
+{
+    if (beatmap == NULL || path == NULL)
+        return -OSUX_ERR_INVAL;
+
+    osub_writer w;
+    for (unsigned i = 0; i < OSUB_SECTION_COUNT; ++i)
+        w.sections[i] = g_array_new(FALSE, FALSE, osub_record_size[i]);
+
+    osub_header *header = g_malloc0(sizeof*header);
+    memcpy(header->magic, OSUB_MAGIC, sizeof header->magic);
+    header->version = OSUB_VERSION;
+    header->byte_order = OSUB_BYTE_ORDER;
+    header->beatmap_size = sizeof(osux_beatmap);
+    write_beatmap(&w, beatmap, &header->beatmap);
+
+    uint64_t offset = ALIGN_UP(sizeof*header);
+    for (unsigned i = 0; i < OSUB_SECTION_COUNT; ++i) {
+        header->record_size[i] = osub_record_size[i];
+        header->sections[i].offset = offset;
+        header->sections[i].count = w.sections[i]->len;
+        offset = ALIGN_UP(offset + osub_record_size[i] * w.sections[i]->len);
+    }
+
+    // written to a temporary file and renamed: readers mapping 'path'
+    // never see it truncated or half written
+    int err = 0;
+    char *tmp_path = g_strdup_printf("%s.XXXXXX", path);
+    int fd = g_mkstemp_full(tmp_path, O_WRONLY, 0644);
+    FILE *f = fd < 0 ? NULL : fdopen(fd, "wb");
+    if (f == NULL) {
+        if (fd >= 0) {
+            close(fd);
+            g_unlink(tmp_path);
+        }
+        err = -OSUX_ERR_FILE_ERROR;
+        goto finally;
+    }
+
+    static char const padding[OSUB_ALIGN] = { 0 };
+    uint64_t pos = fwrite(header, sizeof*header, 1, f) * sizeof*header;
+    for (unsigned i = 0; i < OSUB_SECTION_COUNT; ++i) {
+        size_t size = osub_record_size[i] * w.sections[i]->len;
+        pos += fwrite(padding, 1, header->sections[i].offset - pos, f);
+        pos += fwrite(w.sections[i]->data, 1, size, f);
+    }
+    if (fclose(f) != 0 || pos != header->sections[OSUB_STRINGS].offset
+        + header->sections[OSUB_STRINGS].count ||
+        g_rename(tmp_path, path) < 0) {
+        g_unlink(tmp_path);
+        err = -OSUX_ERR_FILE_ERROR;
+    }
+
+finally:
+    g_free(tmp_path);
+    for (unsigned i = 0; i < OSUB_SECTION_COUNT; ++i)
+        g_array_free(w.sections[i], TRUE);
+    g_free(header);
+    return err;
+}
+
+/* ------------------------------------------------------------------------ */
+/* reader */
+
+typedef struct osub_reader_ {
+    char const *data;
+    osub_header const *header;
+    char const *strings;
+    uint64_t string_size;
+} osub_reader;
+
+static void const *section_data(osub_reader const *r, int id)
+{
+    return r->data + r->header->sections[id].offset;
+}
+
+static bool ref_is_valid(osub_reader const *r, int id, uint64_t ref,
+                         uint64_t count)
+{
+    return ref <= r->header->sections[id].count
+        && count <= r->header->sections[id].count - (ref - 1);
+}
+
+#define CHECK_REF(r_, id_, ref_, count_)                        \
+    do {                                                        \
+        uint64_t ref__ = (ref_);                                \
+        if (ref__ != 0 && !ref_is_valid(r_, id_, ref__, count_)) \
+            return -OSUX_ERR_INVALID_BINARY;                    \
+    } while (0)
+
+static int load_string(osub_reader const *r, char **str)
+{
+    uint64_t ref = FROM_REF(*str);
+    *str = NULL;
+    if (ref == 0)
+        return 0;
+    if (ref > r->string_size)
+        return -OSUX_ERR_INVALID_BINARY;
+    *str = g_strdup(r->strings + ref - 1);
+    return 0;
+}
+
+static void *load_records(osub_reader const *r, int id,
+                          uint64_t ref, uint64_t count)
+{
+    if (ref == 0 || count == 0)
+        return NULL;
+    return g_memdup((char const*) section_data(r, id)
+                    + (ref - 1) * osub_record_size[id],
+                    count * osub_record_size[id]);
+}
+
+static int load_hitobject(osub_reader const *r, osux_beatmap *bm,
+                          osux_hitobject *ho)
+{
+    int err = 0;
+    osux_slider *sl = &ho->slider;
+    uint64_t color = FROM_REF(ho->combo_color);
+    uint64_t tp = FROM_REF(ho->timingpoint);
+    uint64_t points = FROM_REF(sl->points);
+    uint64_t edges = FROM_REF(sl->edgehitsounds);
+
+    // clear every reference first so a failure leaves a freeable object
+    ho->combo_color = NULL;
+    ho->timingpoint = NULL;
+    sl->points = NULL;
+    sl->edgehitsounds = NULL;
+
+    if (color > bm->color_count || tp > bm->timingpoint_count)
+        err = -OSUX_ERR_INVALID_BINARY;
+    if (points != 0 && !ref_is_valid(r, OSUB_POINTS, points, sl->point_count))
+        err = -OSUX_ERR_INVALID_BINARY;
+    if (edges != 0 && (sl->repeat == UINT32_MAX ||
+                       !ref_is_valid(r, OSUB_EDGEHITSOUNDS, edges,
+                                     (uint64_t) sl->repeat + 1)))
+        err = -OSUX_ERR_INVALID_BINARY;
+
+    int e1 = load_string(r, &ho->hitsound.sfx_filename);
+    int e2 = load_string(r, &ho->details);
+    int e3 = load_string(r, &ho->errmsg);
+    if (err < 0 || e1 < 0 || e2 < 0 || e3 < 0)
+        return -OSUX_ERR_INVALID_BINARY;
+
+    if (color != 0)
+        ho->combo_color = &bm->colors[color - 1];
+    if (tp != 0)
+        ho->timingpoint = &bm->timingpoints[tp - 1];
+    sl->points = load_records(r, OSUB_POINTS, points, sl->point_count);
+    if (edges != 0)
+        sl->edgehitsounds = load_records(r, OSUB_EDGEHITSOUNDS,
+                                         edges, sl->repeat + 1);
+    return 0;
+}
+
+static int load_timingpoint(osub_reader const *r, osux_beatmap *bm,
+                            osux_timingpoint *tp)
+{
+    uint64_t last = FROM_REF(tp->last_non_inherited);
+    tp->last_non_inherited = NULL;
+
+    int e1 = load_string(r, &tp->details);
+    int e2 = load_string(r, &tp->errmsg);
+    if (e1 < 0 || e2 < 0 || last > bm->timingpoint_count)
+        return -OSUX_ERR_INVALID_BINARY;
+    if (last != 0)
+        tp->last_non_inherited = &bm->timingpoints[last - 1];
+    return 0;
+}
+
+static int load_command_chain(osub_reader const *r, osux_event_command **cmd)
+{
+    uint64_t ref = FROM_REF(*cmd);
+    osux_event_command **link = cmd;
+    // a chain is at most as long as the section, this bounds corrupt loops
+    uint64_t max_length = r->header->sections[OSUB_COMMANDS].count;
+
+    *link = NULL;
+    for (uint64_t i = 0; ref != 0; ++i) {
+        if (i >= max_length || !ref_is_valid(r, OSUB_COMMANDS, ref, 1))
+            return -OSUX_ERR_INVALID_BINARY;
+
+        osux_event_command *c = load_records(r, OSUB_COMMANDS, ref, 1);
+        ref = FROM_REF(c->next);
+        c->next = NULL;
+        *link = c;
+        link = &c->next;
+        if (load_string(r, &c->trigger) < 0)
+            return -OSUX_ERR_INVALID_BINARY;
+    }
+    return 0;
+}
+
+static int load_event(osub_reader const *r, osux_event *ev)
+{
+    ev->parent = NULL;
+    ev->childs = NULL;
+    ev->child_count = 0;
+    ev->child_bufsize = 0;
+
+    if (EVENT_IS_COMMAND(ev)) {
+        // both calls clear their field even on failure
+        int e1 = load_string(r, &ev->command.trigger);
+        int e2 = load_command_chain(r, &ev->command.next);
+        return e1 < 0 ? e1 : e2;
+    }
+    return load_string(r, &ev->object.filename);
+}
+
+static int load_tags(osub_reader const *r, osux_beatmap *bm)
+{
+    uint64_t ref = FROM_REF(bm->tags);
+    bm->tags = NULL;
+    if (ref == 0)
+        return 0;
+
+    uint64_t const *refs = section_data(r, OSUB_TAGS);
+    uint64_t count = 0;
+    while (ref_is_valid(r, OSUB_TAGS, ref, count + 1) && refs[ref-1+count])
+        ++ count;
+    if (!ref_is_valid(r, OSUB_TAGS, ref, count + 1))
+        return -OSUX_ERR_INVALID_BINARY;
+
+    bm->tags = g_new0(char*, count + 1);
+    for (uint64_t i = 0; i < count; ++i) {
+        bm->tags[i] = TO_REF(char*, refs[ref - 1 + i]);
+        if (load_string(r, &bm->tags[i]) < 0)
+            return -OSUX_ERR_INVALID_BINARY;
+    }
+    return 0;
+}
+
+static gint sort_color(osux_color *a, osux_color *b)
+{
+    return a->id - b->id;
+}
+
+static int load_beatmap(osub_reader const *r, osux_beatmap *bm)
+{
+    int err = 0;
+    osub_header const *h = r->header;
+
+    *bm = h->beatmap;
+
+    // every pointer is cleared before being resolved so the beatmap
+    // can be handed to osux_beatmap_free at any point
+    uint64_t bookmarks = FROM_REF(bm->bookmarks);
+    uint64_t colors = FROM_REF(bm->colors);
+    bm->bookmarks = NULL;
+    bm->colors = NULL;
+    bm->combo_colours = NULL;
+    bm->events = NULL;
+    bm->timingpoints = NULL;
+    memset(&bm->timing_index, 0, sizeof bm->timing_index);
+    bm->hitobjects = NULL;
+    bm->sections = NULL;
+    bm->h_data = NULL;
+    bm->data = NULL;
+
+    uint32_t event_count = bm->event_count;
+    uint32_t timingpoint_count = bm->timingpoint_count;
+    uint32_t hitobject_count = bm->hitobject_count;
+    bm->event_count = bm->event_bufsize = 0;
+    bm->timingpoint_count = bm->timingpoint_bufsize = 0;
+    bm->hitobject_count = bm->hitobject_bufsize = 0;
+
+    #define LOAD_STRING(field_)                                 \
+        if (load_string(r, &bm->field_) < 0)                    \
+            err = -OSUX_ERR_INVALID_BINARY
+
+    LOAD_STRING(md5_hash);
+    LOAD_STRING(osu_filename);
+    LOAD_STRING(file_path);
+    LOAD_STRING(AudioFilename);
+    LOAD_STRING(Title);
+    LOAD_STRING(TitleUnicode);
+    LOAD_STRING(Artist);
+    LOAD_STRING(ArtistUnicode);
+    LOAD_STRING(Creator);
+    LOAD_STRING(Version);
+    LOAD_STRING(Source);
+    LOAD_STRING(Tags);
+
+    #undef LOAD_STRING
+
+    if (load_tags(r, bm) < 0 || err < 0)
+        return -OSUX_ERR_INVALID_BINARY;
+
+    CHECK_REF(r, OSUB_BOOKMARKS, bookmarks, bm->bookmark_count);
+    CHECK_REF(r, OSUB_COLORS, colors, bm->color_count);
+    if (h->sections[OSUB_EVENTS].count != event_count ||
+        h->sections[OSUB_TIMINGPOINTS].count != timingpoint_count ||
+        h->sections[OSUB_HITOBJECTS].count != hitobject_count)
+        return -OSUX_ERR_INVALID_BINARY;
+
+    bm->bookmarks = load_records(r, OSUB_BOOKMARKS,
+                                 bookmarks, bm->bookmark_count);
+    if (bm->bookmarks == NULL)
+        bm->bookmark_count = 0;
+    bm->bookmark_bufsize = bm->bookmark_count;
+
+    bm->colors = load_records(r, OSUB_COLORS, colors, bm->color_count);
+    if (bm->colors == NULL)
+        bm->color_count = 0;
+    bm->color_bufsize = bm->color_count;
+    for (unsigned i = 0; i < bm->color_count; ++i) {
+        if (bm->colors[i].type == COLOR_COMBO)
+            bm->combo_colours = g_list_insert_sorted(
+                bm->combo_colours, &bm->colors[i], (GCompareFunc) sort_color);
+    }
+
+    // arrays are copied in one block, then each record is fixed up;
+    // counts only grow as records become valid
+    bm->timingpoints = load_records(r, OSUB_TIMINGPOINTS, 1, timingpoint_count);
+    bm->timingpoint_bufsize = timingpoint_count;
+    for (unsigned i = 0; i < timingpoint_count; ++i) {
+        bm->timingpoint_count = i + 1;
+        if (load_timingpoint(r, bm, &bm->timingpoints[i]) < 0)
+            return -OSUX_ERR_INVALID_BINARY;
+    }
+    osux_timing_index_init(&bm->timing_index, bm->timingpoints,
+                           bm->timingpoint_count);
+
+    bm->hitobjects = load_records(r, OSUB_HITOBJECTS, 1, hitobject_count);
+    bm->hitobject_bufsize = hitobject_count;
+    for (unsigned i = 0; i < hitobject_count; ++i) {
+        bm->hitobject_count = i + 1;
+        if (load_hitobject(r, bm, &bm->hitobjects[i]) < 0)
+            return -OSUX_ERR_INVALID_BINARY;
+    }
+
+    bm->events = load_records(r, OSUB_EVENTS, 1, event_count);
+    bm->event_bufsize = event_count;
+    for (unsigned i = 0; i < event_count; ++i) {
+        bm->event_count = i + 1;
+        if (load_event(r, &bm->events[i]) < 0)
+            return -OSUX_ERR_INVALID_BINARY;
+    }
+    for (unsigned i = 0; i < event_count; ++i) {
+        if ((err = osux_event_build_tree(&bm->events[i])) < 0)
+            return err;
+    }
+    return 0;
+}
+
+static int check_header(osub_header const *h, uint64_t size)
+{
+    if (size < sizeof*h || memcmp(h->magic, OSUB_MAGIC, sizeof h->magic))
+        return -OSUX_ERR_INVALID_BINARY;
+    if (h->version != OSUB_VERSION || h->byte_order != OSUB_BYTE_ORDER ||
+        h->beatmap_size != sizeof(osux_beatmap))
+        return -OSUX_ERR_BINARY_VERSION;
+
+    for (unsigned i = 0; i < OSUB_SECTION_COUNT; ++i) {
+        osub_section const *s = &h->sections[i];
+        if (h->record_size[i] != osub_record_size[i])
+            return -OSUX_ERR_BINARY_VERSION;
+        if (s->offset % OSUB_ALIGN || s->offset > size ||
+            s->count > (size - s->offset) / osub_record_size[i])
+            return -OSUX_ERR_INVALID_BINARY;
+    }
+
+    // all strings are NUL-terminated, so the pool must end with one
+    osub_section const *strings = &h->sections[OSUB_STRINGS];
+    if (strings->count > 0 &&
+        ((char const*) h)[strings->offset + strings->count - 1] != '\0')
+        return -OSUX_ERR_INVALID_BINARY;
+    return 0;
+}
+
+int osux_beatmap_load_binary(osux_beatmap *beatmap, char const *path)
+{
+    if (beatmap == NULL || path == NULL)
+        return -OSUX_ERR_INVAL;
+    memset(beatmap, 0, sizeof*beatmap);
+
+    GMappedFile *file = g_mapped_file_new(path, FALSE, NULL);
+    if (file == NULL)
+        return -OSUX_ERR_FILE_ACCESS;
+
+    int err;
+    osub_reader r;
+    r.data = g_mapped_file_get_contents(file);
+    r.header = (osub_header const*) r.data;
+    uint64_t size = g_mapped_file_get_length(file);
+
+    // the mapping is only page aligned, which is enough for the header
+    if (r.data == NULL || (err = check_header(r.header, size)) < 0) {
+        err = r.data == NULL ? -OSUX_ERR_INVALID_BINARY : err;
+        goto finally;
+    }
+    r.strings = section_data(&r, OSUB_STRINGS);
+    r.string_size = r.header->sections[OSUB_STRINGS].count;
+
+    if ((err = load_beatmap(&r, beatmap)) < 0)
+        osux_beatmap_free(beatmap);
+
+finally:
+    g_mapped_file_unref(file);
+    return err;
+}
+
+char *osux_beatmap_binary_cache_path(char const *cache_dir,
+                                     char const *md5_hash)
+{
+    if (cache_dir == NULL || md5_hash == NULL)
+        return NULL;
+    char *filename = g_strdup_printf("%s.osub", md5_hash);
+    char *path = g_build_filename(cache_dir, filename, NULL);
+    g_free(filename);
+    return path;
+}
+
+int osux_beatmap_init_cached(osux_beatmap *beatmap, char const *file_path,
+                             char const *cache_dir)
+{
+    if (cache_dir == NULL)
+        return osux_beatmap_init(beatmap, file_path);
+
+    int err;
+    char *md5_hash = osux_get_file_hashstr(file_path);
+    if (md5_hash == NULL)
+        return -OSUX_ERR_FILE_ACCESS;
+
+    char *cache_path = osux_beatmap_binary_cache_path(cache_dir, md5_hash);
+    if (osux_beatmap_load_binary(beatmap, cache_path) == 0 &&
+        !g_strcmp0(beatmap->md5_hash, md5_hash)) {
+        // the cached copy may have been written from another location
+        g_free(beatmap->file_path);
+        beatmap->file_path = g_strdup(file_path);
+        err = 0;
+        goto finally;
+    }
+    osux_beatmap_free(beatmap);
+
+    if ((err = osux_beatmap_init(beatmap, file_path)) < 0)
+        goto finally;
+    // the cache is best effort: failing to write it is not an error
+    if (osux_beatmap_save_binary(beatmap, cache_path) < 0)
+        osux_debug("cannot write beatmap cache '%s'\n", cache_path);
+
+finally:
+    g_free(cache_path);
+    g_free(md5_hash);
+    return err;
+}
@@ -0,0 +1,134 @@
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "osux/beatmap.h"
+#include "osux/error.h"
+
+// maximum number of parsed beatmaps waiting for delivery, per thread
+#define IN_FLIGHT_PER_THREAD 4
+
+typedef struct load_job_ {
+    unsigned index;
+    char const *path;
+    bool metadata_only;
+    char const *cache_dir;
+    int err;
+    osux_beatmap beatmap;
+} load_job;
+
+static void load_job_run(gpointer data, gpointer user_data)
+{
+    load_job *job = data;
+    GAsyncQueue *done = user_data;
+
+    if (job->metadata_only)
+        job->err = osux_beatmap_init_metadata(&job->beatmap, job->path);
+    else
+        job->err = osux_beatmap_init_cached(&job->beatmap, job->path,
+                                            job->cache_dir);
+    g_async_queue_push(done, job);
+}
+
+static void load_job_deliver(load_job *job, osux_beatmap_load_fn callback,
+                             void *user_data)
+{
+    if (job->err < 0) {
+        (*callback)(NULL, job->index, job->err, user_data);
+    } else {
+        (*callback)(&job->beatmap, job->index, job->err, user_data);
+        osux_beatmap_free(&job->beatmap);
+    }
+    g_free(job);
+}
+
+int osux_beatmap_load_many_ex(char const *const *paths, unsigned path_count,
+                              osux_beatmap_load_options const *options,
+                              osux_beatmap_load_fn callback, void *user_data)
+{
+    if (paths == NULL || callback == NULL)
+        return -OSUX_ERR_INVAL;
+    if (path_count == 0)
+        return 0;
+
+    osux_beatmap_load_options defaults = { 0 };
+    if (options == NULL)
+        options = &defaults;
+    int flags = options->flags;
+    bool ordered = (flags & OSUX_BEATMAP_LOAD_ORDERED) != 0;
+    unsigned thread_count = options->thread_count > 0 ?
+        options->thread_count : g_get_num_processors();
+    unsigned max_in_flight = thread_count * IN_FLIGHT_PER_THREAD;
+
+    GAsyncQueue *done = g_async_queue_new();
+    GThreadPool *pool = g_thread_pool_new(
+        &load_job_run, done, thread_count, FALSE, NULL);
+    if (pool == NULL) {
+        g_async_queue_unref(done);
+        return -OSUX_ERR_UNKNOWN_ERROR;
+    }
+
+    // jobs completed out of order, waiting for their turn (ordered mode)
+    load_job **pending = ordered ? g_new0(load_job*, path_count) : NULL;
+    unsigned submitted = 0, delivered = 0, in_flight = 0;
+
+    while (delivered < path_count) {
+        // in ordered mode, the next job to deliver has always been submitted
+        // because jobs are submitted in order: this cannot deadlock
+        while (submitted < path_count && in_flight < max_in_flight) {
+            load_job *job = g_new0(load_job, 1);
+            job->index = submitted;
+            job->path = paths[submitted];
+            job->metadata_only = (flags & OSUX_BEATMAP_LOAD_METADATA) != 0;
+            job->cache_dir = options->cache_dir;
+            g_thread_pool_push(pool, job, NULL);
+            ++ submitted;
+            ++ in_flight;
+        }
+
+        load_job *job = g_async_queue_pop(done);
+        if (!ordered) {
+            load_job_deliver(job, callback, user_data);
+            ++ delivered;
+            -- in_flight;
+            continue;
+        }
+
+        pending[job->index] = job;
+        while (delivered < path_count && pending[delivered] != NULL) {
+            load_job_deliver(pending[delivered], callback, user_data);
+            pending[delivered] = NULL;
+            ++ delivered;
+            -- in_flight;
+        }
+    }
+
+    g_thread_pool_free(pool, FALSE, TRUE);
+    g_async_queue_unref(done);
+    g_free(pending);
+    return 0;
+}
+
+int osux_beatmap_load_many(char const *const *paths, unsigned path_count,
+                           int flags, osux_beatmap_load_fn callback,
+                           void *user_data)
+{
+    osux_beatmap_load_options options = { .flags = flags };
+    return osux_beatmap_load_many_ex(paths, path_count, &options,
+                                     callback, user_data);
+}
@@ -0,0 +1,34 @@
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include <glib.h>
+
+#include "osux/beatmap_set.h"
+
+void osux_beatmap_set_free(osux_beatmap_set *set)
+{
+    g_free(set->creator);
+    g_free(set->artist);
+    g_free(set->artist_unicode);
+    g_free(set->title);
+    g_free(set->title_unicode);
+    g_free(set->display_font);
+    g_free(set->tags);
+    g_free(set->source);
+    g_free(set->directory);
+    memset(set, 0, sizeof *set);
+}
@@ -80,8 +80,8 @@ int osux_color_init(osux_color *c, char *line, uint32_t osu_version)
     static GRegex *regexp = NULL;
     char *type, *data;
 
-    if (regexp == NULL)
-        regexp = g_regex_new("([^:]*):([^:]*)$", 0, 0, NULL);
+    if (g_once_init_enter(&regexp))
+        g_once_init_leave(&regexp, g_regex_new("([^:]*):([^:]*)$", 0, 0, NULL));
 
     (void) osu_version;
     GMatchInfo *info = NULL;
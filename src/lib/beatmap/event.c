@@ -171,7 +171,7 @@ static int parse_break_period_object(
     if (size != 3)
         return -OSUX_ERR_INVALID_EVENT_OBJECT;
     ev->offset = atoi(split[1]);
-    ev->end_offset = atoi(split[1]);
+    ev->end_offset = atoi(split[2]);
     return 0;
 }
 
@@ -279,13 +279,25 @@ int osux_event_free(osux_event *event)
 }
 
 #define EVENT_MAX_STACK_SIZE 200
-static osux_event *event_stack[EVENT_MAX_STACK_SIZE] = { NULL, };
+// one stack per thread so that beatmaps can be loaded concurrently
+static GPrivate event_stack_key = G_PRIVATE_INIT(g_free);
+
+static osux_event **get_event_stack(void)
+{
+    osux_event **event_stack = g_private_get(&event_stack_key);
+    if (event_stack == NULL) {
+        event_stack = g_new0(osux_event*, EVENT_MAX_STACK_SIZE);
+        g_private_set(&event_stack_key, event_stack);
+    }
+    return event_stack;
+}
 
 int osux_event_build_tree(osux_event *event)
 {
     if (event->level >= EVENT_MAX_STACK_SIZE)
         return -OSUX_ERR_MEMORY_TOO_MUCH_NESTED_EVENT;
 
+    osux_event **event_stack = get_event_stack();
     event_stack[event->level] = event;
     if (event->level) {
         osux_event *parent = event_stack[event->level-1];
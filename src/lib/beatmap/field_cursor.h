@@ -0,0 +1,197 @@
+#ifndef OSUX_FIELD_CURSOR_H
+#define OSUX_FIELD_CURSOR_H
+
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Allocation free tokenizer for the comma/pipe/colon separated lines of
+ * the [TimingPoints] and [HitObjects] sections.
+ *
+ * A field is a [begin, end) view into the line; the line is never modified.
+ * Splitting follows g_strsplit: an empty string has no field, otherwise
+ * there is one more field than separators.
+ * Numbers are read like atoi/g_ascii_strtod would (leading blanks, sign,
+ * trailing garbage ignored) so the parsers stay as lenient as before.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct osux_field_ {
+    char const *begin;
+    char const *end;
+} osux_field;
+
+typedef struct osux_field_cursor_ {
+    char const *pos;
+    char const *end;
+    bool done;
+} osux_field_cursor;
+
+static inline void osux_field_cursor_init(osux_field_cursor *c,
+                                          osux_field const *f)
+{
+    c->pos = f->begin;
+    c->end = f->end;
+    c->done = f->begin == f->end;
+}
+
+static inline osux_field osux_field_from_string(char const *str)
+{
+    osux_field f = { str, str + strlen(str) };
+    return f;
+}
+
+/* return false when there is no field left */
+static inline bool osux_field_next(osux_field_cursor *c, char sep,
+                                   osux_field *f)
+{
+    if (c->done)
+        return false;
+    char const *s = memchr(c->pos, sep, c->end - c->pos);
+    f->begin = c->pos;
+    if (s == NULL) {
+        f->end = c->end;
+        c->done = true;
+    } else {
+        f->end = s;
+        c->pos = s + 1;
+    }
+    return true;
+}
+
+/* the unread remainder, as one field */
+static inline osux_field osux_field_cursor_rest(osux_field_cursor const *c)
+{
+    osux_field f = { c->done ? c->end : c->pos, c->end };
+    return f;
+}
+
+static inline bool osux_field_contains(osux_field const *f, char c)
+{
+    return memchr(f->begin, c, f->end - f->begin) != NULL;
+}
+
+static inline unsigned osux_field_count(osux_field const *f, char sep)
+{
+    if (f->begin == f->end)
+        return 0;
+    unsigned count = 1;
+    for (char const *p = f->begin; p < f->end; ++p)
+        count += *p == sep;
+    return count;
+}
+
+static inline bool osux_field_is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v'
+        || c == '\f' || c == '\r';
+}
+
+/*
+ * parse a decimal integer at *p (not beyond 'end'), advance *p past it.
+ * return false when there is no digit (like a failed sscanf("%d"))
+ */
+static inline bool osux_field_read_int64(char const **p, char const *end,
+                                         int64_t *value)
+{
+    char const *s = *p;
+    bool negative = false;
+    uint64_t v = 0;
+
+    while (s < end && osux_field_is_blank(*s))
+        ++ s;
+    if (s < end && (*s == '-' || *s == '+'))
+        negative = *s++ == '-';
+    if (s == end || *s < '0' || *s > '9')
+        return false;
+    while (s < end && *s >= '0' && *s <= '9')
+        v = v * 10 + (*s++ - '0');
+
+    *value = negative ? -(int64_t) v : (int64_t) v;
+    *p = s;
+    return true;
+}
+
+static inline bool osux_field_read_int(char const **p, char const *end,
+                                       int *value)
+{
+    int64_t v;
+    if (!osux_field_read_int64(p, end, &v))
+        return false;
+    *value = (int) v;
+    return true;
+}
+
+/* atoi equivalent: 0 when the field does not start with a number */
+static inline int64_t osux_field_to_int64(osux_field const *f)
+{
+    char const *p = f->begin;
+    int64_t v = 0;
+    osux_field_read_int64(&p, f->end, &v);
+    return v;
+}
+
+static inline int osux_field_to_int(osux_field const *f)
+{
+    return (int) osux_field_to_int64(f);
+}
+
+/*
+ * g_ascii_strtod equivalent.
+ * Plain decimals with at most 15 significant digits (all the values found
+ * in beatmaps) are exact integers divided by an exact power of ten,
+ * which is correctly rounded; anything else goes through g_ascii_strtod.
+ */
+static inline double osux_field_to_double(osux_field const *f)
+{
+    static double const pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+        1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    };
+    char const *s = f->begin;
+    bool negative = false;
+    uint64_t mantissa = 0;
+    unsigned digits = 0, decimals = 0;
+
+    while (s < f->end && osux_field_is_blank(*s))
+        ++ s;
+    if (s < f->end && (*s == '-' || *s == '+'))
+        negative = *s++ == '-';
+    for (; s < f->end && *s >= '0' && *s <= '9'; ++s, ++digits)
+        mantissa = mantissa * 10 + (*s - '0');
+    if (s < f->end && *s == '.') {
+        for (++s; s < f->end && *s >= '0' && *s <= '9'; ++s, ++decimals)
+            mantissa = mantissa * 10 + (*s - '0');
+    }
+    digits += decimals;
+
+    if (digits == 0 || digits > 15 ||
+        (s < f->end && (*s == 'e' || *s == 'E')))
+        return g_ascii_strtod(f->begin, NULL);
+
+    double v = (double) mantissa / pow10[decimals];
+    return negative ? -v : v;
+}
+
+G_END_DECLS
+
+#endif // OSUX_FIELD_CURSOR_H
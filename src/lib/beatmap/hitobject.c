@@ -24,9 +24,10 @@
 #include "osux/hitsound.h"
 #include "osux/util.h"
 #include "osux/error.h"
-#include "osux/string.h"
 #include "osux/mods.h"
 
+#include "field_cursor.h"
+
 static int check_slider_type(char type)
 {
     if (!(type == 'C' || type == 'L' || type == 'P' || type == 'B'))
@@ -34,38 +35,46 @@ static int check_slider_type(char type)
     return 0;
 }
 
-static int parse_slider_points(osux_hitobject *ho, char *pointstr)
+// "%d:%d" as sscanf would read it, trailing characters are ignored
+static bool read_int_pair(osux_field const *f, int *a, int *b)
 {
-    int err = 0;
-    char **spl_points = g_strsplit(pointstr, "|", 0);
-    unsigned size = strsplit_size(spl_points);
+    char const *p = f->begin;
+    return osux_field_read_int(&p, f->end, a)
+        && p < f->end && *p++ == ':'
+        && osux_field_read_int(&p, f->end, b);
+}
+
+static int parse_slider_points(osux_hitobject *ho, osux_field const *curve)
+{
+    osux_field_cursor c;
+    osux_field pt_field;
+    unsigned size = osux_field_count(curve, '|');
 
     ho->slider.point_count = size;
     ho->slider.points = g_malloc(size * sizeof*ho->slider.points);
 
     ho->slider.points[0].x = ho->x;
     ho->slider.points[0].y = ho->y;
-    for (unsigned i = 1; i < size; ++i) {
+
+    osux_field_cursor_init(&c, curve);
+    osux_field_next(&c, '|', &pt_field); // slider type
+    for (unsigned i = 1; osux_field_next(&c, '|', &pt_field); ++i) {
         osux_point *pt = &ho->slider.points[i];
-        if (sscanf(spl_points[i], "%d:%d", &pt->x, &pt->y) != 2) {
-            err = -OSUX_ERR_INVALID_HITOBJECT_SLIDER_POINTS;
+        if (!read_int_pair(&pt_field, &pt->x, &pt->y)) {
             g_free(ho->slider.points);
             ho->slider.points = NULL;
-            break;
+            return -OSUX_ERR_INVALID_HITOBJECT_SLIDER_POINTS;
         }
     }
-
-    g_strfreev(spl_points);
-    return err;
+    return 0;
 }
 
-static int parse_slider_sample_type(osux_hitobject *ho, char *ststr)
+static int parse_slider_sample_type(osux_hitobject *ho, osux_field const *ststr)
 {
-    int err = 0;
-    char **split = g_strsplit(ststr, "|", 0);
-    unsigned size = strsplit_size(split);
+    osux_field_cursor c;
+    osux_field f;
+    unsigned size = osux_field_count(ststr, '|');
     if (size != ho->slider.repeat+1) {
-        g_strfreev(split);
         g_free(ho->slider.edgehitsounds);
         ho->slider.edgehitsounds = NULL;
         return -OSUX_ERR_INVALID_HITOBJECT_EDGE_SAMPLE_TYPE;
@@ -75,24 +84,21 @@ static int parse_slider_sample_type(osux_hitobject *ho, char *ststr)
         ho->slider.edgehitsounds = g_malloc0(
             size * sizeof*ho->slider.edgehitsounds);
     }
-    for (unsigned i = 0; i < size; ++i) {
+    osux_field_cursor_init(&c, ststr);
+    for (unsigned i = 0; osux_field_next(&c, '|', &f); ++i) {
         osux_edgehitsound *eht = &ho->slider.edgehitsounds[i];
-        if (sscanf(split[i], "%d:%d", &eht->sample_type,
-                   &eht->addon_sample_type) != 2) {
-            err = -OSUX_ERR_INVALID_HITOBJECT_EDGE_SAMPLE_TYPE;
-            break;
-        }
+        if (!read_int_pair(&f, &eht->sample_type, &eht->addon_sample_type))
+            return -OSUX_ERR_INVALID_HITOBJECT_EDGE_SAMPLE_TYPE;
     }
-    g_strfreev(split);
-    return err;
+    return 0;
 }
 
-static int parse_slider_sample(osux_hitobject *ho, char *samplestr)
+static int parse_slider_sample(osux_hitobject *ho, osux_field const *samplestr)
 {
-    char **split = g_strsplit(samplestr, "|", 0);
-    unsigned size = strsplit_size(split);
+    osux_field_cursor c;
+    osux_field f;
+    unsigned size = osux_field_count(samplestr, '|');
     if (size != ho->slider.repeat+1) {
-        g_strfreev(split);
         g_free(ho->slider.edgehitsounds);
         ho->slider.edgehitsounds = NULL;
         return -OSUX_ERR_INVALID_HITOBJECT_EDGE_SAMPLE;
@@ -102,11 +108,9 @@ static int parse_slider_sample(osux_hitobject *ho, char *samplestr)
         ho->slider.edgehitsounds = g_malloc0(
             size * sizeof*ho->slider.edgehitsounds);
     }
-    for (unsigned i = 0; i < size; ++i) {
-        osux_edgehitsound *eht = &ho->slider.edgehitsounds[i];
-        eht->sample = atoi(split[i]);
-    }
-    g_strfreev(split);
+    osux_field_cursor_init(&c, samplestr);
+    for (unsigned i = 0; osux_field_next(&c, '|', &f); ++i)
+        ho->slider.edgehitsounds[i].sample = osux_field_to_int(&f);
     return 0;
 }
 
@@ -122,8 +126,13 @@ int osux_hitobject_prepare(osux_hitobject *ho,
                            int combo_id, int combo_pos, osux_color *color,
                            osux_timingpoint const *tp)
 {
-    if (HIT_OBJECT_IS_SLIDER(ho))
-        compute_slider_end_offset(ho, tp);
+    if (tp != NULL) {
+        if (HIT_OBJECT_IS_SLIDER(ho))
+            compute_slider_end_offset(ho, tp);
+        ho->bpm = TP_GET_BPM(tp);
+        ho->slider_velocity = tp->slider_velocity;
+    } else if (HIT_OBJECT_IS_SLIDER(ho))
+        ho->end_offset = ho->offset; // no timing point: unknown duration
 
     ho->timingpoint = tp;
     ho->details = g_strdup_printf(
@@ -137,114 +146,112 @@ int osux_hitobject_prepare(osux_hitobject *ho,
     return 0;
 }
 
-static int parse_slider(osux_hitobject *ho, char **split, unsigned size)
+static int parse_slider(osux_hitobject *ho, osux_field_cursor *c)
 {
     int err = 0;
-    char *curve = split[5];
+    osux_field curve, repeat, length, f;
+
+    if (!osux_field_next(c, ',', &curve) ||
+        !osux_field_next(c, ',', &repeat) ||
+        !osux_field_next(c, ',', &length))
+        return -OSUX_ERR_INVALID_HITOBJECT;
 
-    ho->slider.type = curve[0];
+    ho->slider.type = curve.begin < curve.end ? *curve.begin : '\0';
     if ((err = check_slider_type(ho->slider.type)) < 0)
         return err;
 
-    if ((err = parse_slider_points(ho, curve)) < 0)
+    if ((err = parse_slider_points(ho, &curve)) < 0)
         return err;
 
-    ho->slider.repeat = atoi(split[6]);
-    ho->slider.length = g_ascii_strtod(split[7], NULL);
+    ho->slider.repeat = osux_field_to_int(&repeat);
+    ho->slider.length = osux_field_to_double(&length);
     ho->end_offset = 0; // set later
 
-    for (unsigned i = 8; i < size; ++i) {
-        if (string_contains(split[i], '|') && string_contains(split[i], ':')) {
+    while (osux_field_next(c, ',', &f)) {
+        if (!osux_field_contains(&f, '|'))
+            continue;
+        if (osux_field_contains(&f, ':')) {
             // edge hitsound sample type
-            if ((err = parse_slider_sample_type(ho, split[i])) < 0)
+            if ((err = parse_slider_sample_type(ho, &f)) < 0)
                 return err;
-        } else if (string_contains(split[i], '|') &&
-                   !string_contains(split[i], ':')) {
+        } else {
             // edge hitsound sample
-            if ((err = parse_slider_sample(ho, split[i])) < 0)
+            if ((err = parse_slider_sample(ho, &f)) < 0)
                 return err;
         }
     }
     return 0;
 }
 
-static int parse_spinner(osux_hitobject *ho, char **split, unsigned size)
+static int parse_spinner(osux_hitobject *ho, osux_field_cursor *c)
 {
-    if (size < 6)
+    osux_field end_offset;
+    if (!osux_field_next(c, ',', &end_offset))
         return -OSUX_ERR_INVALID_HITOBJECT_SPINNER;
 
-    ho->end_offset = g_ascii_strtoull(split[5], NULL, 10);
+    ho->end_offset = osux_field_to_int64(&end_offset);
     return 0;
 }
 
-static int parse_hold(osux_hitobject *ho, char **split, unsigned size)
+static int parse_hold(osux_hitobject *ho, osux_field_cursor *c)
 {
-    if (size < 6)
+    osux_field end_offset; // "end_offset:addon_hitsound"
+    if (!osux_field_next(c, ',', &end_offset))
         return -OSUX_ERR_INVALID_HITOBJECT_HOLD;
 
-    ho->end_offset = strtoull(split[5], NULL, 10);
+    ho->end_offset = osux_field_to_int64(&end_offset);
     return 0;
 }
 
-static int parse_addon_hitsound(osux_hitobject *ho, char *addonstr)
+static int parse_addon_hitsound(osux_hitobject *ho, osux_field const *addon)
 {
-    char **split = g_strsplit(addonstr, ":", 0);
-    unsigned size = strsplit_size(split);
+    osux_field_cursor c;
+    osux_field part[5];
+    unsigned size = 0;
 
-    if (HIT_OBJECT_IS_HOLD(ho)) {
-        ++ split;
-        -- size;
-    }
+    osux_field_cursor_init(&c, addon);
+    if (HIT_OBJECT_IS_HOLD(ho)) // skip end offset
+        osux_field_next(&c, ':', &part[0]);
+    while (size < 5 && osux_field_next(&c, ':', &part[size]))
+        ++ size;
 
     if (size < 2 || (ho->_osu_version > 10 && size < 3)
-        || (ho->_osu_version > 11 && size < 4)) {
-        g_strfreev(split);
+        || (ho->_osu_version > 11 && size < 4))
         return -OSUX_ERR_INVALID_HITOBJECT_ADDON_HITSOUND;
-    }
 
-    ho->hitsound.sample_type = atoi(split[0]);
-    ho->hitsound.addon_sample_type = atoi(split[1]);
-
-    if (split[2] != NULL) {
-        ho->hitsound.sample_set_index = atoi(split[2]);
-        if (split[3] != NULL) {
-            ho->hitsound.volume = atoi(split[3]);
-            if (split[4] != NULL)
-                ho->hitsound.sfx_filename = g_strdup(split[4]);
-            else
-                ho->hitsound.sfx_filename = g_strdup("");
-        } else {
-            ho->hitsound.volume = 70;
-            ho->hitsound.sfx_filename = g_strdup("");
-        }
-    } else {
-        ho->hitsound.sample_set_index = 0;
-        ho->hitsound.volume = 70;
+    ho->hitsound.sample_type = osux_field_to_int(&part[0]);
+    ho->hitsound.addon_sample_type = osux_field_to_int(&part[1]);
+    ho->hitsound.sample_set_index = 0;
+    ho->hitsound.volume = 70;
+
+    if (size > 2)
+        ho->hitsound.sample_set_index = osux_field_to_int(&part[2]);
+    if (size > 3)
+        ho->hitsound.volume = osux_field_to_int(&part[3]);
+    if (size > 4)
+        ho->hitsound.sfx_filename = g_strndup(
+            part[4].begin, part[4].end - part[4].begin);
+    else
         ho->hitsound.sfx_filename = g_strdup("");
-    }
-
-    if (HIT_OBJECT_IS_HOLD(ho))
-        -- split;
 
-    g_strfreev(split);
     ho->hitsound.have_addon = true;
     return 0;
 }
 
-static int parse_base_hitobject(osux_hitobject *ho, char **split, unsigned size)
+static int parse_base_hitobject(osux_hitobject *ho, osux_field const *base,
+                                osux_field const *line)
 {
-    g_assert(size >= 5);
-    ho->x = atoi(split[0]);
-    ho->y = atoi(split[1]);
-    ho->offset = atoi(split[2]);
-    ho->type = atoi(split[3]);
-    ho->hitsound.sample = atoi(split[4]);
-
-    if (string_contains(split[size-1], ':') &&
-        !string_contains(split[size-1], '|'))
-    {
+    ho->x = osux_field_to_int(&base[0]);
+    ho->y = osux_field_to_int(&base[1]);
+    ho->offset = osux_field_to_int(&base[2]);
+    ho->type = osux_field_to_int(&base[3]);
+    ho->hitsound.sample = osux_field_to_int(&base[4]);
+
+    // the addon hitsound is always the last field
+    osux_field last = { strrchr(line->begin, ',') + 1, line->end };
+    if (osux_field_contains(&last, ':') && !osux_field_contains(&last, '|')) {
         int err;
-        if ((err = parse_addon_hitsound(ho, split[size-1])) < 0)
+        if ((err = parse_addon_hitsound(ho, &last)) < 0)
             return err;
     }
 
@@ -254,38 +261,38 @@ static int parse_base_hitobject(osux_hitobject *ho, char **split, unsigned size)
 int osux_hitobject_init(osux_hitobject *ho, char *line, uint32_t osu_version)
 {
     int err;
-    char **split = g_strsplit(line, ",", 0);
-    unsigned size = strsplit_size(split);
+    osux_field_cursor c;
+    osux_field base[5];
+    osux_field all = osux_field_from_string(line);
     memset(ho, 0, sizeof *ho);
 
     ho->_osu_version = osu_version;
 
-    if (size < 5) {
-        g_strfreev(split);
-        return -OSUX_ERR_INVALID_HITOBJECT;
+    osux_field_cursor_init(&c, &all);
+    for (unsigned i = 0; i < ARRAY_SIZE(base); ++i) {
+        if (!osux_field_next(&c, ',', &base[i]))
+            return -OSUX_ERR_INVALID_HITOBJECT;
     }
 
-    if ((err = parse_base_hitobject(ho, split, size)) < 0)
+    if ((err = parse_base_hitobject(ho, base, &all)) < 0)
         return err;
 
-    int value = atoi(split[3]);
     /*
-      if (value & HITOBJECT_UNKNOWN_FLAG_MASK) {
+      if (ho->type & HITOBJECT_UNKNOWN_FLAG_MASK) {
       osux_warning("hitobject use extra flag with unknown purposes: %d\n",
-      value & HITOBJECT_UNKNOWN_FLAG_MASK);
+      ho->type & HITOBJECT_UNKNOWN_FLAG_MASK);
       }
     */
 
-    int type = value & HITOBJECT_TYPE_MASK;
+    int type = ho->type & HITOBJECT_TYPE_MASK;
 
     switch (type) {
     case HITOBJECT_CIRCLE: err = 0; ho->end_offset = ho->offset; break;
-    case HITOBJECT_SLIDER: err = parse_slider(ho, split, size); break;
-    case HITOBJECT_SPINNER: err = parse_spinner(ho, split, size); break;
-    case HITOBJECT_HOLD: err = parse_hold(ho, split, size); break;
+    case HITOBJECT_SLIDER: err = parse_slider(ho, &c); break;
+    case HITOBJECT_SPINNER: err = parse_spinner(ho, &c); break;
+    case HITOBJECT_HOLD: err = parse_hold(ho, &c); break;
     default: err = -OSUX_ERR_INVALID_HITOBJECT_TYPE; break;
     }
-    g_strfreev(split);
     return err;
 }
 
@@ -231,21 +231,15 @@ static void taiko_slider_converter_convert(
 
 static osux_list * taiko_autoconvert_ho_list(const osux_beatmap *bm)
 {
-    uint32_t current_tp = 0;
     osux_list *new_ho_list = osux_list_new(LI_FREE, g_free);
 
     for (uint32_t i = 0; i < bm->hitobject_count; ++i) {
 	osux_hitobject *ho = &bm->hitobjects[i];
+	osux_timingpoint const *tp;
+        tp = osux_timing_index_lookup(&bm->timing_index, ho->offset);
 
-        // for each hit object
-        // compute timing point applying on this hit object
-	while (current_tp < (bm->timingpoint_count - 1) &&
-	       bm->timingpoints[current_tp + 1].offset <= ho->offset)
-	    current_tp++;
-
-	osux_timingpoint *tp = &bm->timingpoints[current_tp];
-
-	if (HIT_OBJECT_IS_SPINNER(ho) || HIT_OBJECT_IS_CIRCLE(ho)) {
+	if (HIT_OBJECT_IS_SPINNER(ho) || HIT_OBJECT_IS_CIRCLE(ho) ||
+            tp == NULL) {
 	    // keep spinner and circle
 	    osux_list_append(new_ho_list, hitobject_move(ho));
 	} else if (HIT_OBJECT_IS_SLIDER(ho)) {
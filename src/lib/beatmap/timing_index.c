@@ -0,0 +1,105 @@
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "osux/timing_index.h"
+
+// by offset, then by array position so equal offsets keep the file order
+static int compare_timingpoint(void const *a_, void const *b_)
+{
+    osux_timingpoint const *a = *(osux_timingpoint const *const*) a_;
+    osux_timingpoint const *b = *(osux_timingpoint const *const*) b_;
+
+    if (a->offset != b->offset)
+        return a->offset < b->offset ? -1 : 1;
+    return (a > b) - (a < b);
+}
+
+void osux_timing_index_init(osux_timing_index *index,
+                            osux_timingpoint const *timingpoints,
+                            uint32_t timingpoint_count)
+{
+    bool sorted = true;
+    memset(index, 0, sizeof*index);
+    if (timingpoint_count == 0)
+        return;
+
+    index->points = g_new(osux_timingpoint const*, timingpoint_count);
+    index->uninherited = g_new(osux_timingpoint const*, timingpoint_count);
+    index->point_count = timingpoint_count;
+
+    for (uint32_t i = 0; i < timingpoint_count; ++i) {
+        index->points[i] = &timingpoints[i];
+        if (i > 0 && timingpoints[i].offset < timingpoints[i-1].offset)
+            sorted = false;
+    }
+    // timing points are almost always written in order
+    if (!sorted)
+        qsort(index->points, timingpoint_count,
+              sizeof*index->points, &compare_timingpoint);
+
+    for (uint32_t i = 0; i < timingpoint_count; ++i) {
+        osux_timingpoint const *tp = index->points[i];
+        if (!tp->inherited)
+            index->uninherited[index->uninherited_count++] = tp;
+    }
+}
+
+void osux_timing_index_free(osux_timing_index *index)
+{
+    g_free(index->points);
+    g_free(index->uninherited);
+    memset(index, 0, sizeof*index);
+}
+
+// number of points with an offset lower or equal to 'offset'
+static uint32_t upper_bound(osux_timingpoint const *const *points,
+                            uint32_t count, double offset)
+{
+    uint32_t low = 0, high = count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (points[mid]->offset <= offset)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+static osux_timingpoint const *
+find(osux_timingpoint const *const *points, uint32_t count, double offset)
+{
+    if (count == 0)
+        return NULL;
+    uint32_t i = upper_bound(points, count, offset);
+    return points[i > 0 ? i - 1 : 0];
+}
+
+osux_timingpoint const *
+osux_timing_index_lookup(osux_timing_index const *index, double offset)
+{
+    return find(index->points, index->point_count, offset);
+}
+
+osux_timingpoint const *
+osux_timing_index_uninherited_at(osux_timing_index const *index, double offset)
+{
+    return find(index->uninherited, index->uninherited_count, offset);
+}
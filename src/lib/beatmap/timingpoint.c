@@ -21,6 +21,8 @@
 #include "osux/util.h"
 #include "osux/error.h"
 
+#include "field_cursor.h"
+
 static int min_size_version[] = {
     [0]  = 99999,
     [1]  = 99999,
@@ -47,39 +49,44 @@ static int min_size_version[] = {
 
 int osux_timingpoint_init(osux_timingpoint *tp, char *line, uint32_t osu_version)
 {
-    char **split = g_strsplit(line, ",", 0);
-    int size = strsplit_size(split);
-    tp->_osu_version = osu_version;
+    osux_field_cursor c;
+    osux_field split[8];
+    osux_field all = osux_field_from_string(line);
+    int size = 0;
 
     memset(tp, 0, sizeof*tp);
+    tp->_osu_version = osu_version;
     g_assert( osu_version < ARRAY_SIZE(min_size_version));
 
-    if (size < min_size_version[osu_version]) {
-        g_strfreev(split);
+    // fields past the 8th are ignored
+    osux_field_cursor_init(&c, &all);
+    while (size < (int) ARRAY_SIZE(split) &&
+           osux_field_next(&c, ',', &split[size]))
+        ++ size;
+
+    if (size < min_size_version[osu_version])
         return -OSUX_ERR_INVALID_TIMINGPOINT;
-    }
 
-    tp->offset = g_ascii_strtod(split[0], NULL);
-    tp->millisecond_per_beat = g_ascii_strtod(split[1], NULL);
+    tp->offset = osux_field_to_double(&split[0]);
+    tp->millisecond_per_beat = osux_field_to_double(&split[1]);
     if (osu_version <= 3)
         return 0;
 
-    tp->time_signature = atoi(split[2]);
-    tp->sample_type = atoi(split[3]);
-    tp->sample_set_index = atoi(split[4]);
+    tp->time_signature = osux_field_to_int(&split[2]);
+    tp->sample_type = osux_field_to_int(&split[3]);
+    tp->sample_set_index = osux_field_to_int(&split[4]);
     if (osu_version <= 4)
         return 0;
 
-    tp->volume = atoi(split[5]);
-    tp->inherited = size >= 7 ? (atoi(split[6]) == 0) : false;
-    tp->kiai = size >= 8 ? (atoi(split[7]) != 0) : false;
+    tp->volume = osux_field_to_int(&split[5]);
+    tp->inherited = size >= 7 ? (osux_field_to_int(&split[6]) == 0) : false;
+    tp->kiai = size >= 8 ? (osux_field_to_int(&split[7]) != 0) : false;
 
     if (tp->inherited) {
         tp->slider_velocity_multiplier = tp->millisecond_per_beat;
         tp->millisecond_per_beat = 0.; // set later
     } else
         tp->slider_velocity_multiplier = -100.; // default value
-    g_strfreev(split);
     return 0;
 }
 
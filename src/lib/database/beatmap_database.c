@@ -1,10 +1,16 @@
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <dirent.h>
 #include "osux/beatmap.h"
 #include "osux/error.h"
 #include "osux/string.h"
+#include "osux/util.h"
 #include "osux/beatmap_database.h"
 #include "beatmap_db.sql.h"
 
+// PRAGMA user_version set by beatmap_db.sql
+#define BEATMAP_DB_SCHEMA_VERSION 5
+
 static int init_schema(osux_beatmap_db *db)
 {
     return osux_database_exec_query(&db->base, (char*) _beatmap_db_data, NULL);
@@ -24,184 +30,1180 @@ static bool beatmap_table_is_present(osux_beatmap_db *db)
     return present;
 }
 
-#define DB_BIND_INT(db, name, text)                                     \
-    if ((ret = osux_database_bind_int(&(db)->base, (":"name), (text))) < 0) \
-        return ret
+static int find_file_size_column(osux_database_row const *row, void *present)
+{
+    // PRAGMA table_info: cid, name, type, ...
+    *(bool*) present = !g_strcmp0(osux_database_column_text(row, 1),
+                                  "file_size");
+    return *(bool*) present;
+}
+
+/* the file_size column was added after the first schema */
+static int ensure_file_size_column(osux_beatmap_db *db)
+{
+    bool present = false;
+    int err = osux_database_foreach_row(
+        &db->base, "PRAGMA table_info(beatmap)",
+        &find_file_size_column, &present);
+    if (!err && !present)
+        err = osux_database_exec_query(
+            &db->base, "ALTER TABLE beatmap ADD COLUMN file_size int", NULL);
+    return err;
+}
+
+#define BEATMAP_COLUMNS(COLUMN)                                 \
+    COLUMN(INT, osu_beatmap_id, bm->BeatmapID)                  \
+    COLUMN(INT, game_mode, bm->Mode)                            \
+    COLUMN(TEXT, audio_filename, bm->AudioFilename)             \
+    COLUMN(TEXT, diff_name, bm->Version)                        \
+    COLUMN(MD5, md5_hash, bm->md5_hash)                         \
+    COLUMN(TEXT, osu_filename, bm->osu_filename)                \
+    COLUMN(TEXT, file_path, bm->file_path)                      \
+    COLUMN(INT, circles, bm->circles)                           \
+    COLUMN(INT, sliders, bm->sliders)                           \
+    COLUMN(INT, spinners, bm->spinners)                         \
+    COLUMN(INT64, last_modification, bm->last_modification)     \
+    COLUMN(INT64, last_checked, bm->last_checked)               \
+    COLUMN(DOUBLE, approach_rate, bm->ApproachRate)             \
+    COLUMN(DOUBLE, circle_size, bm->CircleSize)                 \
+    COLUMN(DOUBLE, hp_drain, bm->HPDrainRate)                   \
+    COLUMN(DOUBLE, overall_diff, bm->OverallDifficulty)         \
+    COLUMN(DOUBLE, slider_velocity, bm->SliderMultiplier)       \
+    COLUMN(DOUBLE, stack_leniency, bm->StackLeniency)           \
+    COLUMN(INT, drain_time, bm->drain_time)                     \
+    COLUMN(INT, total_time, bm->total_time)                     \
+    COLUMN(INT, preview_time, bm->PreviewTime)                  \
+    COLUMN(INT, bpm_avg, bm->bpm_avg)                           \
+    COLUMN(INT, bpm_max, bm->bpm_max)                           \
+    COLUMN(INT, bpm_min, bm->bpm_min)                           \
+    COLUMN(INT, local_offset, bm->local_offset)                 \
+    COLUMN(INT, online_offset, bm->online_offset)               \
+    COLUMN(INT, already_played, bm->already_played)             \
+    COLUMN(INT, last_played, bm->last_played)                   \
+    COLUMN(INT, ignore_hitsound, bm->ignore_hitsound)           \
+    COLUMN(INT, ignore_skin, bm->ignore_skin)                   \
+    COLUMN(INT, disable_sb, bm->disable_sb)                     \
+    COLUMN(INT, disable_video, bm->disable_video)               \
+    COLUMN(INT, visual_override, bm->visual_override)           \
+    COLUMN(INT, mania_scroll_speed, bm->mania_scroll_speed)     \
+    COLUMN(INT64, file_size, file_size)                         \
+    COLUMN(INT64, beatmap_set_id, set_id)                       \
+
+#define COLUMN_TO_ENUM(type, name, value) BEATMAP_COLUMN_##name,
+#define COLUMN_TO_NAME(type, name, value) #name,
+
+enum beatmap_column {
+    BEATMAP_COLUMNS(COLUMN_TO_ENUM)
+    BEATMAP_COLUMN_COUNT,
+};
+
+static char const *const beatmap_column_names[] = {
+    BEATMAP_COLUMNS(COLUMN_TO_NAME)
+};
+
+#define BIND_INT(db, index, value)                              \
+    osux_database_bind_int_at(&(db)->base, (index), (value))
+#define BIND_INT64(db, index, value)                            \
+    osux_database_bind_int64_at(&(db)->base, (index), (value))
+#define BIND_DOUBLE(db, index, value)                           \
+    osux_database_bind_double_at(&(db)->base, (index), (value))
+#define BIND_TEXT(db, index, value)                             \
+    osux_database_bind_string_at(&(db)->base, (index), (value))
+#define BIND_MD5(db, index, value)                              \
+    bind_md5(&(db)->base, (index), (value))
+
+// md5 hashes are stored as 16 byte blobs, NULL if not a valid hash
+static int bind_md5(osux_database *db, int index, char const *md5_hash)
+{
+    uint8_t digest[OSUX_HASH_INDEX_DIGEST_LENGTH];
+    if (!osux_md5_hash_to_digest(md5_hash, digest))
+        return osux_database_bind_blob_at(db, index, NULL, 0);
+    return osux_database_bind_blob_at(db, index, digest, sizeof digest);
+}
+
+// "0123..." from a blob column, NULL if it is not a digest
+static char *column_md5_hash(osux_database_row const *row, int col)
+{
+    int size;
+    void const *digest = osux_database_column_blob(row, col, &size);
+    if (digest == NULL || size != OSUX_HASH_INDEX_DIGEST_LENGTH)
+        return NULL;
+    return bytearray2hexstr(digest, size);
+}
+
+#define BIND_COLUMN(type, name, value)                                  \
+    ret = BIND_##type(db, db->insert_params[BEATMAP_COLUMN_##name], (value)); \
+    if (ret < 0)                                                        \
+        return ret;
+
+// "INSERT INTO beatmap (a, b, ...) VALUES (:a, :b, ...)"
+static char *beatmap_insert_query(void)
+{
+    GString *query = g_string_new("INSERT INTO beatmap (");
+    for (unsigned i = 0; i < BEATMAP_COLUMN_COUNT; ++i)
+        g_string_append_printf(query, "%s%s", i ? ", " : "",
+                               beatmap_column_names[i]);
+    g_string_append(query, ") VALUES (");
+    for (unsigned i = 0; i < BEATMAP_COLUMN_COUNT; ++i)
+        g_string_append_printf(query, "%s:%s", i ? ", " : "",
+                               beatmap_column_names[i]);
+    g_string_append(query, ")");
+    return g_string_free(query, FALSE);
+}
+
+static int prepare_beatmap_insert(osux_beatmap_db *db)
+{
+    char *query = beatmap_insert_query();
+    db->insert_stmt = osux_database_statement(&db->base, query);
+    g_free(query);
+    if (db->insert_stmt == NULL)
+        return -OSUX_ERR_DATABASE;
 
-#define DB_BIND_DOUBLE(db, name, text)                                  \
-    if ((ret = osux_database_bind_double(&(db)->base, (":"name), (text))) < 0) \
-        return ret
+    osux_database_use_statement(&db->base, db->insert_stmt);
+    db->insert_params = g_new(int, BEATMAP_COLUMN_COUNT);
+    for (unsigned i = 0; i < BEATMAP_COLUMN_COUNT; ++i) {
+        char *name = g_strdup_printf(":%s", beatmap_column_names[i]);
+        db->insert_params[i] = osux_database_parameter_index(&db->base, name);
+        g_free(name);
+    }
+    return 0;
+}
 
-#define DB_BIND_TEXT(db, name, text)                                    \
-    if ((ret = osux_database_bind_string(&(db)->base, (":"name), (text))) < 0) \
-        return ret
+static int read_set_id(osux_database_row const *row, void *set_id)
+{
+    *(int64_t*) set_id = osux_database_column_int64(row, 0);
+    return 1;
+}
 
-static int beatmap_insert(osux_beatmap_db *db, osux_beatmap *bm)
+/*
+ * One beatmap set per directory. The set row is created by the first
+ * beatmap found in the directory; 'bm' may be NULL when only the
+ * directory is known.
+ */
+static int get_beatmap_set_id(osux_beatmap_db *db, char const *file_path,
+                              osux_beatmap const *bm, int64_t *set_id)
 {
     int ret;
-    if (!db->insert_prepared) {
+    char *directory = g_path_get_dirname(file_path);
+    int64_t *cached;
+
+    if (db->set_ids == NULL)
+        db->set_ids = g_hash_table_new_full(
+            g_str_hash, g_str_equal, g_free, g_free);
+    if ((cached = g_hash_table_lookup(db->set_ids, directory)) != NULL) {
+        *set_id = *cached;
+        g_free(directory);
+        return 0;
+    }
+
+    ret = osux_database_prepare_query(
+        &db->base, "INSERT OR IGNORE INTO beatmap_set (directory) VALUES (?)");
+    if (!ret)
+        ret = osux_database_bind_string_at(&db->base, 1, directory);
+    if (!ret)
+        ret = osux_database_exec_prepared_query(&db->base, NULL);
+    // sets created from a directory name only get their metadata here
+    if (!ret && bm != NULL)
+        ret = osux_database_prepare_query(
+            &db->base, "UPDATE beatmap_set SET osu_beatmap_set_id = ?,"
+            " creator = ?, artist = ?, artist_unicode = ?, title = ?,"
+            " title_unicode = ?, tags = ?, source = ?"
+            " WHERE directory = ? AND title IS NULL");
+    if (!ret && bm != NULL) {
+        osux_database_bind_int64_at(&db->base, 1, bm->BeatmapSetID);
+        osux_database_bind_string_at(&db->base, 2, bm->Creator);
+        osux_database_bind_string_at(&db->base, 3, bm->Artist);
+        osux_database_bind_string_at(&db->base, 4, bm->ArtistUnicode);
+        osux_database_bind_string_at(&db->base, 5, bm->Title);
+        osux_database_bind_string_at(&db->base, 6, bm->TitleUnicode);
+        osux_database_bind_string_at(&db->base, 7, bm->Tags);
+        osux_database_bind_string_at(&db->base, 8, bm->Source);
+        ret = osux_database_bind_string_at(&db->base, 9, directory);
+        if (!ret)
+            ret = osux_database_exec_prepared_query(&db->base, NULL);
+    }
+    if (!ret)
         ret = osux_database_prepare_query(
-            &db->base, "INSERT INTO beatmap "
-            "(osu_beatmap_id, game_mode, audio_filename, diff_name,"
-            "md5_hash, osu_filename, file_path,"
-            "circles, sliders, spinners, last_modification, last_checked,"
-            "approach_rate, circle_size, hp_drain, overall_diff,"
-            "slider_velocity, stack_leniency, drain_time, total_time,"
-            "preview_time, bpm_avg, bpm_max, bpm_min, local_offset,"
-            "online_offset, already_played, last_played, ignore_hitsound,"
-            "ignore_skin, disable_sb, disable_video, visual_override,"
-            "mania_scroll_speed)"
-            " VALUES"
-            "(:osu_beatmap_id, :game_mode, :audio_filename, :diff_name,"
-            ":md5_hash, :osu_filename, :file_path,"
-            ":circles, :sliders, :spinners, :last_modification, :last_checked,"
-            ":approach_rate, :circle_size, :hp_drain, :overall_diff,"
-            ":slider_velocity, :stack_leniency, :drain_time, :total_time,"
-            ":preview_time, :bpm_avg, :bpm_max, :bpm_min, :local_offset,"
-            ":online_offset, :already_played, :last_played, :ignore_hitsound,"
-            ":ignore_skin, :disable_sb, :disable_video, :visual_override,"
-            ":mania_scroll_speed)");
-        if (ret < 0)
+            &db->base, "SELECT beatmap_set_id FROM beatmap_set"
+            " WHERE directory = ?");
+    if (!ret)
+        ret = osux_database_bind_string_at(&db->base, 1, directory);
+    *set_id = -1;
+    if (!ret)
+        ret = osux_database_foreach_prepared_row(&db->base,
+                                                 &read_set_id, set_id);
+    if (!ret && *set_id < 0)
+        ret = -OSUX_ERR_DATABASE;
+    if (ret < 0) {
+        g_free(directory);
+        return ret;
+    }
+    g_hash_table_insert(db->set_ids, directory, g_memdup(set_id, sizeof *set_id));
+    return 0;
+}
+
+/* recompute the aggregated columns of beatmap_set from its beatmaps */
+static int update_set_stats(osux_beatmap_db *db)
+{
+    return osux_database_exec_query(
+        &db->base, "UPDATE beatmap_set SET (difficulty_count, bpm_min, bpm_max,"
+        " object_count_min, object_count_max, drain_time_min, drain_time_max)"
+        " = (SELECT count(*), min(bpm_min), max(bpm_max),"
+        " min(circles + sliders + spinners), max(circles + sliders + spinners),"
+        " min(drain_time), max(drain_time) FROM beatmap"
+        " WHERE beatmap.beatmap_set_id = beatmap_set.beatmap_set_id)", NULL);
+}
+
+static int beatmap_insert(osux_beatmap_db *db, osux_beatmap const *bm,
+                          int64_t file_size)
+{
+    int ret;
+    int64_t set_id;
+
+    if ((ret = get_beatmap_set_id(db, bm->file_path, bm, &set_id)) < 0)
+        return ret;
+    if (db->insert_stmt == NULL) {
+        if ((ret = prepare_beatmap_insert(db)) < 0)
             return ret;
-        db->insert_prepared = true;
-    }
-
-    DB_BIND_INT(db, "osu_beatmap_id", bm->BeatmapID);
-    DB_BIND_INT(db, "game_mode", bm->Mode);
-    DB_BIND_TEXT(db, "audio_filename", bm->AudioFilename);
-    DB_BIND_TEXT(db, "md5_hash", bm->md5_hash);
-    DB_BIND_TEXT(db, "osu_filename", bm->osu_filename);
-    DB_BIND_TEXT(db, "file_path", bm->file_path);
-    DB_BIND_TEXT(db, "diff_name", bm->Version);
-    DB_BIND_INT(db, "circles", bm->circles);
-    DB_BIND_INT(db, "sliders", bm->sliders);
-    DB_BIND_INT(db, "spinners", bm->spinners);
-    DB_BIND_INT(db, "last_modification", bm->last_modification);
-    DB_BIND_INT(db, "last_checked", bm->last_checked);
-    DB_BIND_DOUBLE(db, "approach_rate", bm->ApproachRate);
-    DB_BIND_DOUBLE(db, "circle_size", bm->CircleSize);
-    DB_BIND_DOUBLE(db, "hp_drain", bm->HPDrainRate);
-    DB_BIND_DOUBLE(db, "overall_diff", bm->OverallDifficulty);
-    DB_BIND_DOUBLE(db, "slider_velocity", bm->SliderMultiplier);
-    DB_BIND_DOUBLE(db, "stack_leniency", bm->StackLeniency);
-    DB_BIND_INT(db, "drain_time", bm->drain_time);
-    DB_BIND_INT(db, "total_time", bm->total_time);
-    DB_BIND_INT(db, "preview_time", bm->PreviewTime);
-    DB_BIND_INT(db, "bpm_avg", bm->bpm_avg);
-    DB_BIND_INT(db, "bpm_min", bm->bpm_min);
-    DB_BIND_INT(db, "bpm_max", bm->bpm_max);
-    DB_BIND_INT(db, "local_offset", bm->local_offset);
-    DB_BIND_INT(db, "online_offset", bm->online_offset);
-    DB_BIND_INT(db, "already_played", bm->already_played);
-    DB_BIND_INT(db, "last_played", bm->last_played);
-    DB_BIND_INT(db, "ignore_hitsound", bm->ignore_hitsound);
-    DB_BIND_INT(db, "ignore_skin", bm->ignore_skin);
-    DB_BIND_INT(db, "disable_sb", bm->disable_sb);
-    DB_BIND_INT(db, "disable_video", bm->disable_video);
-    DB_BIND_INT(db, "visual_override", bm->visual_override);
-    DB_BIND_INT(db, "mania_scroll_speed", bm->mania_scroll_speed);
+    } else
+        osux_database_use_statement(&db->base, db->insert_stmt);
 
+    BEATMAP_COLUMNS(BIND_COLUMN);
     return osux_database_exec_prepared_query(&db->base, NULL);
 }
 
-static int load_beatmap_from_disk(
-    osux_beatmap_db *db, const char *filepath)
+// minimum time between two progress lines, in microseconds
+#define PROGRESS_INTERVAL (G_USEC_PER_SEC / 2)
+
+static void report_progress(osux_beatmap_db *db)
 {
-    int err = 0;
-    osux_beatmap beatmap;
+    int64_t now = g_get_monotonic_time();
+    if (now - db->last_progress < PROGRESS_INTERVAL)
+        return;
+    db->last_progress = now;
+    printf("%% %lu beatmaps\n", db->parsed_beatmap_count);
+    fflush(stdout);
+}
 
-    if ((err = osux_beatmap_init(&beatmap, filepath)) < 0) {
-        osux_error("Cannot load beatmap\nfilename:%s\nerror type: %s\n\n",
-                   filepath, osux_errmsg(err));
+int osux_beatmap_db_bulk_begin(osux_beatmap_db *db, unsigned batch_size)
+{
+    if (db->bulk_size > 0 || batch_size == 0)
+        return -OSUX_ERR_INVAL;
+    db->bulk_size = batch_size;
+    db->bulk_pending = 0;
+    return osux_database_exec_query(&db->base, "BEGIN", NULL);
+}
+
+int osux_beatmap_db_bulk_end(osux_beatmap_db *db)
+{
+    if (db->bulk_size == 0)
+        return -OSUX_ERR_INVAL;
+    db->bulk_size = 0;
+    return osux_database_exec_query(&db->base, "COMMIT", NULL);
+}
+
+int osux_beatmap_db_insert(osux_beatmap_db *db, osux_beatmap const *bm,
+                           int64_t file_size)
+{
+    int err;
+    if ((err = beatmap_insert(db, bm, file_size)) < 0)
         return err;
+
+    ++ db->parsed_beatmap_count;
+    report_progress(db);
+    if (db->bulk_size > 0 && ++db->bulk_pending >= db->bulk_size) {
+        db->bulk_pending = 0;
+        err = osux_database_exec_query(&db->base, "COMMIT; BEGIN", NULL);
     }
-    if ((err = beatmap_insert(db, &beatmap) < 0))
-        fprintf(stderr, "inserting beatmap '%s' failed\n", beatmap.file_path);
-    else {
-        ++ db->parsed_beatmap_count;
-        if (beatmap.BeatmapID)
-            printf("%% %ld %s [%s]\n",
-                   beatmap.BeatmapID, beatmap.Title, beatmap.Version);
+    return err;
+}
+
+/* fingerprint used to detect modified files without reading them */
+typedef struct beatmap_file_ {
+    int64_t size;
+    int64_t mtime;
+} beatmap_file;
+
+typedef struct beatmap_db_loader_ {
+    osux_beatmap_db *db;
+    GPtrArray *paths;
+    GArray *files; // beatmap_file, same index as 'paths'
+    int64_t now;
+} beatmap_db_loader;
+
+static void beatmap_db_loader_init(beatmap_db_loader *loader,
+                                   osux_beatmap_db *db)
+{
+    loader->db = db;
+    loader->paths = g_ptr_array_new_with_free_func(g_free);
+    loader->files = g_array_new(FALSE, FALSE, sizeof(beatmap_file));
+    loader->now = g_get_real_time() / G_USEC_PER_SEC;
+}
+
+static void beatmap_db_loader_free(beatmap_db_loader *loader)
+{
+    g_ptr_array_free(loader->paths, TRUE);
+    g_array_free(loader->files, TRUE);
+}
+
+static void beatmap_db_loader_add(beatmap_db_loader *loader,
+                                  char *path, beatmap_file const *file)
+{
+    g_ptr_array_add(loader->paths, path);
+    g_array_append_val(loader->files, *file);
+}
+
+static void insert_parsed_beatmap(osux_beatmap_db *db, osux_beatmap *beatmap,
+                                  int err, char const *path,
+                                  beatmap_file const *file, int64_t now)
+{
+    if (err < 0) {
+        osux_error("Cannot load beatmap\nfilename:%s\nerror type: %s\n\n",
+                   path, osux_errmsg(err));
+        return;
+    }
+
+    beatmap->last_modification = file->mtime;
+    beatmap->last_checked = now;
+    if (osux_beatmap_db_insert(db, beatmap, file->size) < 0)
+        fprintf(stderr, "inserting beatmap '%s' failed\n", beatmap->file_path);
+}
+
+static void insert_loaded_beatmap(
+    osux_beatmap *beatmap, unsigned index, int err, void *user_data)
+{
+    beatmap_db_loader *loader = user_data;
+    insert_parsed_beatmap(
+        loader->db, beatmap, err, g_ptr_array_index(loader->paths, index),
+        &g_array_index(loader->files, beatmap_file, index), loader->now);
+}
+
+/* ------------------------------------------------------------------------ */
+/* directory walk */
+
+typedef void (*beatmap_path_fn)(char *path, void *user_data);
+
+static bool entry_is_directory(char const *path, struct dirent const *entry)
+{
+#ifdef _DIRENT_HAVE_D_TYPE
+    // the type is known without a stat on most file systems
+    if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_LNK)
+        return entry->d_type == DT_DIR;
+#else
+    (void) entry;
+#endif
+    return g_file_test(path, G_FILE_TEST_IS_DIR);
+}
+
+/* call 'fn' with each .osu file under 'path'; 'fn' owns the path */
+static void walk_beatmap_directory(char const *path,
+                                   beatmap_path_fn fn, void *user_data)
+{
+    DIR *dir;
+    struct dirent *entry;
+
+    if ((dir = opendir(path)) == NULL)
+        return;
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            continue;
+        char *file_entry = g_strdup_printf("%s/%s", path, entry->d_name);
+        if (entry_is_directory(file_entry, entry)) {
+            walk_beatmap_directory(file_entry, fn, user_data);
+            g_free(file_entry);
+        } else if (!string_have_extension(file_entry, ".osu")) {
+            g_free(file_entry); // ignore non-osu file
+        } else
+            (*fn)(file_entry, user_data);
+    }
+    closedir(dir);
+}
+
+static bool stat_beatmap_file(char const *path, beatmap_file *file)
+{
+    GStatBuf st;
+    if (g_stat(path, &st) < 0)
+        return false;
+    file->size = st.st_size;
+    file->mtime = st.st_mtime;
+    return true;
+}
+
+static void collect_beatmap_path(char *path, void *user_data)
+{
+    beatmap_file file;
+    if (stat_beatmap_file(path, &file))
+        beatmap_db_loader_add(user_data, path, &file);
+    else
+        g_free(path);
+}
+
+static void collect_beatmap_paths(char const *path, beatmap_db_loader *loader)
+{
+    walk_beatmap_directory(path, &collect_beatmap_path, loader);
+}
+
+static int load_and_insert(beatmap_db_loader *loader)
+{
+    // beatmaps are parsed in parallel but inserted from this thread only
+    return osux_beatmap_load_many(
+        (char const *const*) loader->paths->pdata, loader->paths->len,
+        OSUX_BEATMAP_LOAD_METADATA, &insert_loaded_beatmap, loader);
+}
+
+/* ------------------------------------------------------------------------ */
+/* population pipeline: walker thread -> parser threads -> writer */
+
+// rows per transaction while populating
+#define POPULATE_BATCH_SIZE 1000
+
+// capacity of each queue, per parser thread
+#define QUEUE_SLOTS_PER_THREAD 8
+
+/*
+ * GAsyncQueue with a maximum length: a producer takes a slot token
+ * before pushing and the consumer gives it back after popping.
+ */
+typedef struct bounded_queue_ {
+    GAsyncQueue *items;
+    GAsyncQueue *slots;
+} bounded_queue;
+
+static void bounded_queue_init(bounded_queue *q, unsigned capacity)
+{
+    q->items = g_async_queue_new();
+    q->slots = g_async_queue_new();
+    for (unsigned i = 0; i < capacity; ++i)
+        g_async_queue_push(q->slots, GINT_TO_POINTER(1));
+}
+
+static void bounded_queue_free(bounded_queue *q)
+{
+    g_async_queue_unref(q->items);
+    g_async_queue_unref(q->slots);
+}
+
+static void bounded_queue_push(bounded_queue *q, gpointer item)
+{
+    g_async_queue_pop(q->slots);
+    g_async_queue_push(q->items, item);
+}
+
+static gpointer bounded_queue_pop(bounded_queue *q)
+{
+    gpointer item = g_async_queue_pop(q->items);
+    g_async_queue_push(q->slots, GINT_TO_POINTER(1));
+    return item;
+}
+
+// pushed once per parser thread after the last item of a stage
+static char end_of_stream;
+
+typedef struct parsed_beatmap_ {
+    char *path;
+    beatmap_file file;
+    int err;
+    osux_beatmap beatmap;
+} parsed_beatmap;
+
+typedef struct populate_pipeline_ {
+    char const *song_dir;
+    unsigned parser_count;
+    bounded_queue paths;   // char*, from the walker to the parsers
+    bounded_queue parsed;  // parsed_beatmap*, from the parsers to the writer
+} populate_pipeline;
+
+static void queue_beatmap_path(char *path, void *user_data)
+{
+    populate_pipeline *pipeline = user_data;
+    bounded_queue_push(&pipeline->paths, path);
+}
+
+static gpointer walker_thread(gpointer data)
+{
+    populate_pipeline *pipeline = data;
+
+    walk_beatmap_directory(pipeline->song_dir, &queue_beatmap_path, pipeline);
+    for (unsigned i = 0; i < pipeline->parser_count; ++i)
+        bounded_queue_push(&pipeline->paths, &end_of_stream);
+    return NULL;
+}
+
+static gpointer parser_thread(gpointer data)
+{
+    populate_pipeline *pipeline = data;
+    char *path;
+
+    while ((path = bounded_queue_pop(&pipeline->paths)) != &end_of_stream) {
+        parsed_beatmap *pb = g_new0(parsed_beatmap, 1);
+        pb->path = path;
+        if (!stat_beatmap_file(path, &pb->file))
+            pb->err = -OSUX_ERR_FILE_ACCESS;
         else
-            printf("%% %s [%s]\n", beatmap.Title, beatmap.Version);
+            pb->err = osux_beatmap_init_metadata(&pb->beatmap, path);
+        bounded_queue_push(&pipeline->parsed, pb);
     }
-    osux_beatmap_free(&beatmap);
-    return err;
+    bounded_queue_push(&pipeline->parsed, &end_of_stream);
+    return NULL;
 }
 
-static gboolean parse_beatmap_directory(osux_beatmap_db *db, char const *path)
+/*
+ * The walker and the parsers run on their own threads; the calling thread
+ * is the only one touching the database and just consumes parsed rows.
+ */
+static int parse_beatmap_directory(osux_beatmap_db *db, char const *path)
 {
-    GDir *dir = NULL;
-    const gchar *entry_name;
+    int err;
+    populate_pipeline pipeline;
+    int64_t now = g_get_real_time() / G_USEC_PER_SEC;
 
     assert( db != NULL );
+    if ((err = osux_beatmap_db_bulk_begin(db, POPULATE_BATCH_SIZE)) < 0)
+        return err;
 
-    if ((dir = g_dir_open(path, 0, NULL)) == NULL)
-        return -1;
-    if ((entry_name = g_dir_read_name(dir)) == NULL)
-        return 0;
+    pipeline.song_dir = path;
+    pipeline.parser_count = g_get_num_processors();
+    bounded_queue_init(&pipeline.paths,
+                       pipeline.parser_count * QUEUE_SLOTS_PER_THREAD);
+    bounded_queue_init(&pipeline.parsed,
+                       pipeline.parser_count * QUEUE_SLOTS_PER_THREAD);
 
-    do {
-        char *file_entry = g_strdup_printf("%s/%s", path, entry_name);
-        if (g_file_test(file_entry, G_FILE_TEST_IS_DIR)) {
-            // with GLib "." and ".." directories are ommited on Unix platforms
-            parse_beatmap_directory(db, file_entry);
-            g_free(file_entry);
-        } else {
-            if (!string_have_extension(file_entry, ".osu")) {
-                g_free(file_entry); // ignore non-osu file
-                continue;
-            }
-            load_beatmap_from_disk(db, file_entry);
-            g_free(file_entry);
+    GThread *walker = g_thread_new("walker", &walker_thread, &pipeline);
+    GThread **parsers = g_new(GThread*, pipeline.parser_count);
+    for (unsigned i = 0; i < pipeline.parser_count; ++i)
+        parsers[i] = g_thread_new("parser", &parser_thread, &pipeline);
+
+    unsigned running = pipeline.parser_count;
+    while (running > 0) {
+        parsed_beatmap *pb = bounded_queue_pop(&pipeline.parsed);
+        if ((void*) pb == &end_of_stream) {
+            -- running;
+            continue;
         }
-    } while ((entry_name = g_dir_read_name(dir)) != NULL);
-    g_dir_close(dir);
+        insert_parsed_beatmap(db, &pb->beatmap, pb->err,
+                              pb->path, &pb->file, now);
+        if (pb->err >= 0)
+            osux_beatmap_free(&pb->beatmap);
+        g_free(pb->path);
+        g_free(pb);
+    }
+
+    g_thread_join(walker);
+    for (unsigned i = 0; i < pipeline.parser_count; ++i)
+        g_thread_join(parsers[i]);
+    g_free(parsers);
+    bounded_queue_free(&pipeline.paths);
+    bounded_queue_free(&pipeline.parsed);
+
+    // in the last batch, with the last rows
+    if ((err = update_set_stats(db)) < 0) {
+        osux_beatmap_db_bulk_end(db);
+        return err;
+    }
+    return osux_beatmap_db_bulk_end(db);
+}
+
+/* ------------------------------------------------------------------------ */
+/* incremental synchronisation */
+
+typedef struct stored_beatmap_ {
+    int64_t beatmap_id;
+    beatmap_file file;
+    char *md5_hash;
+    bool seen; // still on disk (possibly under another path)
+} stored_beatmap;
+
+static void stored_beatmap_free(stored_beatmap *sb)
+{
+    g_free(sb->md5_hash);
+    g_free(sb);
+}
+
+static int add_stored_beatmap(osux_database_row const *row, void *stored)
+{
+    char const *path = osux_database_column_text(row, 1);
+    if (path == NULL)
+        return 0;
+
+    stored_beatmap *sb = g_new0(stored_beatmap, 1);
+    sb->beatmap_id = osux_database_column_int64(row, 0);
+    sb->md5_hash = column_md5_hash(row, 2);
+    // rows written before file_size existed never match a file on disk
+    sb->file.size = osux_database_column_is_null(row, 3) ?
+        -1 : osux_database_column_int64(row, 3);
+    sb->file.mtime = osux_database_column_int64(row, 4);
+    g_hash_table_replace(stored, g_strdup(path), sb);
     return 0;
 }
 
+/* file_path -> stored_beatmap */
+static GHashTable *load_stored_beatmaps(osux_beatmap_db *db)
+{
+    GHashTable *stored = g_hash_table_new_full(
+        g_str_hash, g_str_equal, g_free, (GDestroyNotify) stored_beatmap_free);
+
+    osux_database_foreach_row(
+        &db->base, "SELECT beatmap_id, file_path, md5_hash, file_size, "
+        "last_modification FROM beatmap", &add_stored_beatmap, stored);
+    return stored;
+}
+
+static int update_renamed_beatmap(osux_beatmap_db *db, stored_beatmap *sb,
+                                  char const *path, int64_t now)
+{
+    int ret;
+    int64_t set_id;
+    char *osu_filename = g_path_get_basename(path);
+
+    // the file may have moved to another set directory
+    ret = get_beatmap_set_id(db, path, NULL, &set_id);
+    if (!ret)
+        ret = osux_database_prepare_query(
+            &db->base, "UPDATE beatmap SET file_path = :file_path,"
+            " osu_filename = :osu_filename, file_size = :file_size,"
+            " last_modification = :last_modification,"
+            " last_checked = :last_checked, beatmap_set_id = :beatmap_set_id"
+            " WHERE beatmap_id = :beatmap_id");
+    if (!ret)
+        ret = osux_database_bind_int64(&db->base, ":beatmap_set_id", set_id);
+    if (!ret)
+        ret = osux_database_bind_string(&db->base, ":file_path", path);
+    if (!ret)
+        ret = osux_database_bind_string(
+            &db->base, ":osu_filename", osu_filename);
+    if (!ret)
+        ret = osux_database_bind_int64(
+            &db->base, ":file_size", sb->file.size);
+    if (!ret)
+        ret = osux_database_bind_int64(
+            &db->base, ":last_modification", sb->file.mtime);
+    if (!ret)
+        ret = osux_database_bind_int64(&db->base, ":last_checked", now);
+    if (!ret)
+        ret = osux_database_bind_int64(
+            &db->base, ":beatmap_id", sb->beatmap_id);
+    if (!ret)
+        ret = osux_database_exec_prepared_query(&db->base, NULL);
+    g_free(osu_filename);
+    return ret;
+}
+
+static int delete_stale_beatmaps(osux_beatmap_db *db, GArray *ids)
+{
+    int ret;
+    if (ids->len == 0)
+        return 0;
+
+    ret = osux_database_prepare_query(
+        &db->base, "DELETE FROM beatmap WHERE beatmap_id = :beatmap_id");
+    for (unsigned i = 0; !ret && i < ids->len; ++i) {
+        ret = osux_database_bind_int64(
+            &db->base, ":beatmap_id", g_array_index(ids, int64_t, i));
+        if (!ret)
+            ret = osux_database_exec_prepared_query(&db->base, NULL);
+    }
+    return ret;
+}
+
+static int delete_empty_sets(osux_beatmap_db *db)
+{
+    if (db->set_ids != NULL)
+        g_hash_table_remove_all(db->set_ids);
+    return osux_database_exec_query(
+        &db->base, "DELETE FROM beatmap_set WHERE beatmap_set_id NOT IN"
+        " (SELECT beatmap_set_id FROM beatmap"
+        " WHERE beatmap_set_id IS NOT NULL)", NULL);
+}
+
+int osux_beatmap_db_sync(osux_beatmap_db *db)
+{
+    int err;
+    beatmap_db_loader disk, parse;
+    unsigned unchanged = 0, changed = 0, renamed = 0, removed = 0;
+
+    GHashTable *stored = load_stored_beatmaps(db);
+    GHashTable *vanished = g_hash_table_new(g_str_hash, g_str_equal);
+    GArray *stale_ids = g_array_new(FALSE, FALSE, sizeof(int64_t));
+    GPtrArray *new_paths = g_ptr_array_new();
+    GArray *new_files = g_array_new(FALSE, FALSE, sizeof(beatmap_file));
+
+    beatmap_db_loader_init(&disk, db);
+    beatmap_db_loader_init(&parse, db);
+    collect_beatmap_paths(db->song_dir, &disk);
+
+    // 1. known paths: keep untouched files, reparse modified ones
+    for (unsigned i = 0; i < disk.paths->len; ++i) {
+        char *path = g_ptr_array_index(disk.paths, i);
+        beatmap_file *file = &g_array_index(disk.files, beatmap_file, i);
+        stored_beatmap *sb = g_hash_table_lookup(stored, path);
+
+        if (sb == NULL) {
+            g_ptr_array_add(new_paths, path);
+            g_array_append_val(new_files, *file);
+            continue;
+        }
+        sb->seen = true;
+        if (sb->file.size == file->size && sb->file.mtime == file->mtime) {
+            ++ unchanged;
+            continue;
+        }
+        ++ changed;
+        g_array_append_val(stale_ids, sb->beatmap_id);
+        beatmap_db_loader_add(&parse, g_strdup(path), file);
+    }
+
+    // 2. new paths: a vanished row with the same md5 is a moved file
+    GHashTableIter iter;
+    stored_beatmap *sb;
+    g_hash_table_iter_init(&iter, stored);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer*) &sb)) {
+        if (!sb->seen && sb->md5_hash != NULL)
+            g_hash_table_insert(vanished, sb->md5_hash, sb);
+    }
+
+    err = osux_database_exec_query(&db->base, "BEGIN", NULL);
+    for (unsigned i = 0; !err && i < new_paths->len; ++i) {
+        char *path = g_ptr_array_index(new_paths, i);
+        beatmap_file *file = &g_array_index(new_files, beatmap_file, i);
+        char *md5_hash = NULL;
+
+        // hashing is only worth it when something disappeared
+        if (g_hash_table_size(vanished) > 0)
+            md5_hash = osux_get_file_hashstr(path);
+        sb = md5_hash ? g_hash_table_lookup(vanished, md5_hash) : NULL;
+        if (sb != NULL) {
+            g_hash_table_remove(vanished, md5_hash);
+            sb->seen = true;
+            sb->file = *file;
+            err = update_renamed_beatmap(db, sb, path, disk.now);
+            ++ renamed;
+        } else
+            beatmap_db_loader_add(&parse, g_strdup(path), file);
+        g_free(md5_hash);
+    }
+
+    // 3. rows whose file is gone, and old versions of modified files
+    g_hash_table_iter_init(&iter, stored);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer*) &sb)) {
+        if (!sb->seen) {
+            g_array_append_val(stale_ids, sb->beatmap_id);
+            ++ removed;
+        }
+    }
+    if (!err)
+        err = delete_stale_beatmaps(db, stale_ids);
+
+    if (!err)
+        err = load_and_insert(&parse);
+    if (!err)
+        err = delete_empty_sets(db);
+    if (!err)
+        err = update_set_stats(db);
+    if (!err)
+        err = osux_database_exec_query(&db->base, "COMMIT", NULL);
+    else
+        osux_database_exec_query(&db->base, "ROLLBACK", NULL);
+
+    if (!err)
+        printf("sync: %u unchanged, %u modified, %u renamed, %u removed, "
+               "%u new.\n", unchanged, changed, renamed, removed,
+               parse.paths->len - changed);
+
+    beatmap_db_loader_free(&parse);
+    beatmap_db_loader_free(&disk);
+    g_array_free(new_files, TRUE);
+    g_ptr_array_free(new_paths, TRUE);
+    g_array_free(stale_ids, TRUE);
+    g_hash_table_destroy(vanished);
+    g_hash_table_destroy(stored);
+    return err;
+}
+
+static int copy_first_text(osux_database_row const *row, void *result)
+{
+    *(char**) result = g_strdup(osux_database_column_text(row, 0));
+    return 1;
+}
+
 char *osux_beatmap_db_get_path_by_hash(
     osux_beatmap_db *db, char const *md5_hash)
 {
-    osux_list *query_result = osux_list_new(LI_FREE, osux_hashtable_delete);
-    db->insert_prepared = false;
-    osux_database_prepare_query(&db->base, "SELECT file_path FROM beatmap "
-                                "WHERE md5_hash = :hash");
-    osux_database_bind_string(&db->base, ":hash", md5_hash);
-    osux_database_exec_prepared_query(&db->base, query_result);
-
-    char *res = NULL;
-    if (osux_list_size(query_result) != 0) {
-        osux_hashtable *dict = (osux_hashtable*) osux_list_get(query_result, 1);
-        if (osux_hashtable_lookup(dict, "file_path", &res) < 0)
-            res = NULL;
-        else
-            res = g_strdup(res);
+    char *path = NULL;
+    if (db->hash_index != NULL)
+        return g_strdup(osux_hash_index_lookup(db->hash_index, md5_hash));
+
+    if (db->path_by_hash_stmt == NULL) {
+        db->path_by_hash_stmt = osux_database_statement(
+            &db->base, "SELECT file_path FROM beatmap WHERE md5_hash = ?");
+        if (db->path_by_hash_stmt == NULL)
+            return NULL;
+    }
+    osux_database_use_statement(&db->base, db->path_by_hash_stmt);
+    if (bind_md5(&db->base, 1, md5_hash) < 0)
+        return NULL;
+    osux_database_foreach_prepared_row(&db->base, &copy_first_text, &path);
+    return path;
+}
+
+unsigned osux_beatmap_db_resolve_many(osux_beatmap_db *db,
+                                      char const *const *hashes,
+                                      unsigned count, char **out_paths)
+{
+    unsigned found = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        out_paths[i] = osux_beatmap_db_get_path_by_hash(db, hashes[i]);
+        found += out_paths[i] != NULL;
+    }
+    return found;
+}
+
+static int append_text(osux_database_row const *row, void *array)
+{
+    char *text = g_strdup(osux_database_column_text(row, 0));
+    g_ptr_array_add(array, text);
+    return 0;
+}
+
+char **osux_beatmap_db_get_set_paths_by_hash(
+    osux_beatmap_db *db, char const *md5_hash)
+{
+    int err = osux_database_prepare_query(
+        &db->base, "SELECT file_path FROM beatmap WHERE beatmap_set_id ="
+        " (SELECT beatmap_set_id FROM beatmap WHERE md5_hash = ?)");
+    if (!err)
+        err = bind_md5(&db->base, 1, md5_hash);
+    if (err < 0)
+        return NULL;
+
+    GPtrArray *paths = g_ptr_array_new();
+    err = osux_database_foreach_prepared_row(&db->base, &append_text, paths);
+    if (err < 0) {
+        g_ptr_array_free(paths, TRUE);
+        return NULL;
     }
-    osux_list_free(query_result);
-    return res;
+    g_ptr_array_add(paths, NULL);
+    return (char**) g_ptr_array_free(paths, FALSE);
+}
+
+static int32_t column_int32(osux_database_row const *row, int col)
+{
+    return (int32_t) osux_database_column_int64(row, col);
+}
+
+static int copy_beatmap_set(osux_database_row const *row, void *set_)
+{
+    osux_beatmap_set *set = set_;
+    set->id = (uint32_t) osux_database_column_int64(row, 0);
+    set->osu_id = column_int32(row, 1);
+    set->creator = g_strdup(osux_database_column_text(row, 2));
+    set->artist = g_strdup(osux_database_column_text(row, 3));
+    set->artist_unicode = g_strdup(osux_database_column_text(row, 4));
+    set->title = g_strdup(osux_database_column_text(row, 5));
+    set->title_unicode = g_strdup(osux_database_column_text(row, 6));
+    set->display_font = g_strdup(osux_database_column_text(row, 7));
+    set->tags = g_strdup(osux_database_column_text(row, 8));
+    set->source = g_strdup(osux_database_column_text(row, 9));
+    set->directory = g_strdup(osux_database_column_text(row, 10));
+    set->status = column_int32(row, 11);
+    set->difficulty_count = (uint32_t) osux_database_column_int64(row, 12);
+    set->bpm_min = column_int32(row, 13);
+    set->bpm_max = column_int32(row, 14);
+    set->object_count_min = column_int32(row, 15);
+    set->object_count_max = column_int32(row, 16);
+    set->drain_time_min = column_int32(row, 17);
+    set->drain_time_max = column_int32(row, 18);
+    return 1;
+}
+
+int osux_beatmap_db_get_set_by_hash(osux_beatmap_db *db, char const *md5_hash,
+                                    osux_beatmap_set *set)
+{
+    int err = osux_database_prepare_query(
+        &db->base, "SELECT beatmap_set_id, osu_beatmap_set_id, creator,"
+        " artist, artist_unicode, title, title_unicode, display_font, tags,"
+        " source, directory, status, difficulty_count, bpm_min, bpm_max,"
+        " object_count_min, object_count_max, drain_time_min, drain_time_max"
+        " FROM beatmap_set WHERE beatmap_set_id ="
+        " (SELECT beatmap_set_id FROM beatmap WHERE md5_hash = ?)");
+    if (!err)
+        err = bind_md5(&db->base, 1, md5_hash);
+    if (err < 0)
+        return err;
+
+    memset(set, 0, sizeof *set);
+    err = osux_database_foreach_prepared_row(&db->base, &copy_beatmap_set, set);
+    if (err < 0)
+        return err;
+    return set->directory != NULL ? 0 : -OSUX_ERR_DATABASE;
+}
+
+static int add_hash_index_entry(osux_database_row const *row, void *index)
+{
+    int size;
+    void const *digest = osux_database_column_blob(row, 0, &size);
+    char const *path = osux_database_column_text(row, 1);
+    if (digest != NULL && size == OSUX_HASH_INDEX_DIGEST_LENGTH && path != NULL)
+        osux_hash_index_add_digest(index, digest, path);
+    return 0;
+}
+
+static int get_index_source(char const *db_path,
+                            osux_hash_index_source *source)
+{
+    GStatBuf st;
+    if (db_path == NULL || g_stat(db_path, &st) < 0)
+        return -OSUX_ERR_FILE_ACCESS;
+    source->size = st.st_size;
+    source->mtime_sec = st.st_mtim.tv_sec;
+    source->mtime_nsec = st.st_mtim.tv_nsec;
+    return 0;
+}
+
+static bool same_index_source(osux_hash_index_source const *a,
+                              osux_hash_index_source const *b)
+{
+    return a->size == b->size && a->mtime_sec == b->mtime_sec
+        && a->mtime_nsec == b->mtime_nsec;
+}
+
+int osux_beatmap_db_load_hash_index(osux_beatmap_db *db,
+                                    char const *sidecar_path)
+{
+    int err;
+    osux_hash_index *index = g_new(osux_hash_index, 1);
+
+    // taken before reading the rows: a later write changes the source
+    osux_hash_index_source source;
+    bool has_source = sidecar_path != NULL &&
+        get_index_source(db->base.file_path, &source) == 0;
+    if (has_source && osux_hash_index_load(index, sidecar_path) == 0) {
+        if (same_index_source(&index->source, &source))
+            goto loaded;
+        osux_hash_index_free(index);
+    }
+
+    osux_hash_index_init(index);
+    err = osux_database_foreach_row(
+        &db->base, "SELECT md5_hash, file_path FROM beatmap",
+        &add_hash_index_entry, index);
+    if (err < 0) {
+        osux_hash_index_free(index);
+        g_free(index);
+        return err;
+    }
+    osux_hash_index_sort(index);
+    if (has_source) {
+        index->source = source;
+        if (osux_hash_index_save(index, sidecar_path) < 0)
+            osux_warning("cannot write hash index '%s'\n", sidecar_path);
+    }
+
+loaded:
+    if (db->hash_index != NULL) {
+        osux_hash_index_free(db->hash_index);
+        g_free(db->hash_index);
+    }
+    db->hash_index = index;
+    return 0;
+}
+
+static int read_schema_version(osux_database_row const *row, void *version)
+{
+    *(int64_t*) version = osux_database_column_int64(row, 0);
+    return 1;
+}
+
+typedef struct v1_migration_ {
+    osux_beatmap_db *db;
+    int err;
+} v1_migration;
+
+static int copy_v1_beatmap(osux_database_row const *row, void *migration_)
+{
+    v1_migration *migration = migration_;
+    osux_beatmap_db *db = migration->db;
+    int64_t beatmap_id = osux_database_column_int64(row, 0);
+    char const *md5_hash = osux_database_column_text(row, 1);
+    char const *file_path = osux_database_column_text(row, 2);
+    int64_t set_id = -1;
+    int ret = 0;
+
+    if (file_path != NULL)
+        ret = get_beatmap_set_id(db, file_path, NULL, &set_id);
+    if (!ret)
+        ret = osux_database_prepare_query(
+            &db->base, "UPDATE beatmap SET md5_hash = ?, beatmap_set_id = ?"
+            " WHERE beatmap_id = ?");
+    if (!ret)
+        ret = bind_md5(&db->base, 1, md5_hash);
+    if (!ret && set_id >= 0)
+        ret = osux_database_bind_int64_at(&db->base, 2, set_id);
+    if (!ret)
+        ret = osux_database_bind_int64_at(&db->base, 3, beatmap_id);
+    if (!ret)
+        ret = osux_database_exec_prepared_query(&db->base, NULL);
+    migration->err = ret;
+    return ret < 0; // stop at the first error
+}
+
+/*
+ * Version 1 stored md5 hashes as text and never filled beatmap_set.
+ * Rows are copied to the new table, then the hashes are converted and
+ * the sets are created from the directories (the set metadata is not in
+ * the old table: it is filled when the set is scanned again).
+ */
+static int migrate_from_v1(osux_beatmap_db *db)
+{
+    int err = ensure_file_size_column(db);
+    if (!err)
+        err = osux_database_exec_query(
+            &db->base, "ALTER TABLE beatmap RENAME TO beatmap_v1", NULL);
+    if (!err)
+        err = init_schema(db);
+    if (!err) {
+        GString *columns = g_string_new("beatmap_id");
+        for (unsigned i = 0; i < BEATMAP_COLUMN_COUNT; ++i) {
+            if (i != BEATMAP_COLUMN_beatmap_set_id)
+                g_string_append_printf(columns, ", %s",
+                                       beatmap_column_names[i]);
+        }
+        char *query = g_strdup_printf(
+            "INSERT INTO beatmap (%s) SELECT %s FROM beatmap_v1",
+            columns->str, columns->str);
+        err = osux_database_exec_query(&db->base, query, NULL);
+        g_free(query);
+        g_string_free(columns, TRUE);
+    }
+    if (!err) {
+        v1_migration migration = { db, 0 };
+        err = osux_database_foreach_row(
+            &db->base, "SELECT beatmap_id, md5_hash, file_path FROM beatmap_v1",
+            &copy_v1_beatmap, &migration);
+        if (!err)
+            err = migration.err;
+    }
+    if (!err)
+        err = osux_database_exec_query(&db->base, "DROP TABLE beatmap_v1", NULL);
+    return err;
+}
+
+/* version 2 had no aggregated columns in beatmap_set */
+static int migrate_from_v2(osux_beatmap_db *db)
+{
+    return osux_database_exec_query(
+        &db->base,
+        "ALTER TABLE beatmap_set ADD COLUMN difficulty_count int;"
+        "ALTER TABLE beatmap_set ADD COLUMN bpm_min int;"
+        "ALTER TABLE beatmap_set ADD COLUMN bpm_max int;"
+        "ALTER TABLE beatmap_set ADD COLUMN object_count_min int;"
+        "ALTER TABLE beatmap_set ADD COLUMN object_count_max int;"
+        "ALTER TABLE beatmap_set ADD COLUMN drain_time_min int;"
+        "ALTER TABLE beatmap_set ADD COLUMN drain_time_max int;"
+        "PRAGMA user_version = 3;", NULL);
+}
+
+/* version 3 never filled drain_time and total_time: parse every file again */
+static int migrate_from_v3(osux_beatmap_db *db)
+{
+    return osux_database_exec_query(
+        &db->base,
+        "UPDATE beatmap SET file_size = NULL;"
+        "PRAGMA user_version = 4;", NULL);
+}
+
+/* version 4 counted the break periods in drain_time: parse again */
+static int migrate_from_v4(osux_beatmap_db *db)
+{
+    return osux_database_exec_query(
+        &db->base,
+        "UPDATE beatmap SET file_size = NULL;"
+        "PRAGMA user_version = 5;", NULL);
+}
+
+static int upgrade_schema(osux_beatmap_db *db)
+{
+    int64_t version = 0;
+    int err = osux_database_foreach_row(
+        &db->base, "PRAGMA user_version", &read_schema_version, &version);
+    if (err < 0)
+        return err;
+
+    if (version > BEATMAP_DB_SCHEMA_VERSION) {
+        osux_error("beatmap database schema version %ld is not supported\n",
+                   (long) version);
+        return -OSUX_ERR_DATABASE;
+    }
+    if (version == BEATMAP_DB_SCHEMA_VERSION)
+        return 0;
+    if (db->base.read_only) {
+        osux_error("beatmap database schema version %ld must be upgraded,"
+                   " open it for writing once\n", (long) version);
+        return -OSUX_ERR_DATABASE;
+    }
+
+    if ((err = osux_database_exec_query(&db->base, "BEGIN", NULL)) < 0)
+        return err;
+    if (version < 2)
+        err = migrate_from_v1(db); // straight to the current schema
+    else {
+        if (version < 3)
+            err = migrate_from_v2(db);
+        if (!err && version < 4)
+            err = migrate_from_v3(db);
+        if (!err)
+            err = migrate_from_v4(db);
+    }
+    if (!err)
+        err = update_set_stats(db);
+
+    if (!err)
+        return osux_database_exec_query(&db->base, "COMMIT", NULL);
+    osux_database_exec_query(&db->base, "ROLLBACK", NULL);
+    if (db->set_ids != NULL)
+        g_hash_table_remove_all(db->set_ids);
+    return err;
 }
 
 int osux_beatmap_db_init(
-    osux_beatmap_db *db, char const *file_path, char const *song_dir, bool populate)
+    osux_beatmap_db *db, char const *file_path, char const *song_dir, int flags)
 {
     int err;
+    bool populate = (flags & OSUX_BEATMAP_DB_POPULATE) != 0;
+    bool read_only = (flags & OSUX_BEATMAP_DB_READ_ONLY) != 0;
+
     memset(db, 0, sizeof*db);
-    if ((err = osux_database_init(&db->base, file_path)) < 0)
+    if (populate && read_only)
+        return -OSUX_ERR_INVAL;
+    // rebuilding the whole table is faster in memory, lookups are not;
+    // nothing is kept from the file, so the memory copy starts empty
+    int open_flags = 0;
+    if (populate)
+        open_flags = OSUX_DATABASE_IN_MEMORY | OSUX_DATABASE_EMPTY;
+    else if (read_only)
+        open_flags = OSUX_DATABASE_READ_ONLY;
+    if ((err = osux_database_open(&db->base, file_path, open_flags)) < 0)
         return err;
 
     db->song_dir = g_strdup(song_dir);
     db->song_dir_length = strlen(song_dir);
-    db->insert_prepared = false;
-
-    if (populate || !beatmap_table_is_present(db)) {
-        if ((err = init_schema(db)) < 0)
-            return err;
-        if (populate) {
-            parse_beatmap_directory(db, song_dir);
-            printf("parsed %lu beatmap%s.\n",
-                   db->parsed_beatmap_count, db->parsed_beatmap_count ? "s":"");
-        }
+
+    if (!populate && beatmap_table_is_present(db)) {
+        err = upgrade_schema(db);
+    } else if (read_only) {
+        osux_error("%s: not a beatmap database\n", file_path);
+        err = -OSUX_ERR_DATABASE;
+    } else if ((err = init_schema(db)) == 0 && populate) {
+        err = parse_beatmap_directory(db, song_dir);
+        printf("parsed %lu beatmap%s.\n",
+               db->parsed_beatmap_count, db->parsed_beatmap_count ? "s":"");
+        if (!err)
+            err = osux_database_save(&db->base);
+    }
+
+    if (err < 0) {
+        osux_beatmap_db_free(db);
+        return err;
     }
     return 0;
 }
@@ -209,12 +1211,52 @@ int osux_beatmap_db_init(
 int osux_beatmap_db_free(osux_beatmap_db *db)
 {
     g_free(db->song_dir);
+    g_free(db->insert_params);
+    if (db->hash_index != NULL) {
+        osux_hash_index_free(db->hash_index);
+        g_free(db->hash_index);
+    }
+    if (db->set_ids != NULL)
+        g_hash_table_destroy(db->set_ids);
     osux_database_free(&db->base);
     memset(db, 0, sizeof*db);
     return 0;
 }
 
+// every column of beatmap, with md5 hashes as hex strings
+static GString *beatmap_select_query(void)
+{
+    GString *query = g_string_new("SELECT beatmap_id");
+    for (unsigned i = 0; i < BEATMAP_COLUMN_COUNT; ++i) {
+        if (i == BEATMAP_COLUMN_md5_hash)
+            g_string_append(query, ", lower(hex(md5_hash)) AS md5_hash");
+        else
+            g_string_append_printf(query, ", %s", beatmap_column_names[i]);
+    }
+    g_string_append(query, " FROM beatmap");
+    return query;
+}
+
 int osux_beatmap_db_dump(osux_beatmap_db *db, FILE *out)
 {
-    return osux_database_print_query(&db->base, "SELECT * FROM beatmap", out);
+    GString *query = beatmap_select_query();
+    int err = osux_database_print_query(&db->base, query->str, out);
+    g_string_free(query, TRUE);
+    return err;
+}
+
+int osux_beatmap_db_foreach_metadata_by_path(
+    osux_beatmap_db *db, char const *file_path,
+    osux_database_row_fn callback, void *user_data)
+{
+    GString *query = beatmap_select_query();
+    g_string_append(query, " WHERE file_path = ?");
+    int err = osux_database_prepare_query(&db->base, query->str);
+    g_string_free(query, TRUE);
+
+    if (!err)
+        err = osux_database_bind_string_at(&db->base, 1, file_path);
+    if (!err)
+        err = osux_database_foreach_prepared_row(&db->base, callback, user_data);
+    return err;
 }
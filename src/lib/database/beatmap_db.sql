@@ -16,7 +16,16 @@ CREATE TABLE beatmap_set
         tags                text,
         source              text,
         directory           text,
-        status              int
+        status              int,
+
+        -- aggregated over the difficulties of the set
+        difficulty_count    int,
+        bpm_min             int,
+        bpm_max             int,
+        object_count_min    int,
+        object_count_max    int,
+        drain_time_min      int,
+        drain_time_max      int
 );
 
 CREATE TABLE beatmap
@@ -31,15 +40,16 @@ CREATE TABLE beatmap
 
         audio_filename  text,
         diff_name       text,
-        md5_hash        text UNIQUE,
+        md5_hash        blob, -- 16 bytes
         osu_filename    text,
         file_path       text,
+        file_size       int,
         
         circles         int,
         sliders         int,
         spinners        int,
-        last_modification       text,
-        last_checked            text,
+        last_modification       int,
+        last_checked            int,
         
         approach_rate   real,
         circle_size     real,
@@ -70,3 +80,10 @@ CREATE TABLE beatmap
         mania_scroll_speed      int,
         FOREIGN KEY(beatmap_set_id) REFERENCES beatmap_set(beatmap_set_id)  
 );
+
+-- hash lookups are answered from the index alone
+CREATE INDEX beatmap_md5_hash ON beatmap(md5_hash, file_path, game_mode);
+CREATE INDEX beatmap_set_id ON beatmap(beatmap_set_id);
+CREATE UNIQUE INDEX beatmap_set_directory ON beatmap_set(directory);
+
+PRAGMA user_version = 5;
@@ -1,3 +1,3 @@
 #include "./beatmap_db.sql.h"
-const unsigned char _beatmap_db_data[] = {0x0a,0x44,0x52,0x4f,0x50,0x20,0x54,0x41,0x42,0x4c,0x45,0x20,0x49,0x46,0x20,0x45,0x58,0x49,0x53,0x54,0x53,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x3b,0x0a,0x44,0x52,0x4f,0x50,0x20,0x54,0x41,0x42,0x4c,0x45,0x20,0x49,0x46,0x20,0x45,0x58,0x49,0x53,0x54,0x53,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x3b,0x0a,0x0a,0x43,0x52,0x45,0x41,0x54,0x45,0x20,0x54,0x41,0x42,0x4c,0x45,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x0a,0x28,0x0a,0x2d,0x2d,0x20,0x64,0x6f,0x20,0x6e,0x6f,0x74,0x20,0x72,0x65,0x70,0x6c,0x61,0x63,0x65,0x20,0x69,0x6e,0x74,0x65,0x67,0x65,0x72,0x20,0x62,0x79,0x20,0x69,0x6e,0x74,0x20,0x66,0x6f,0x72,0x20,0x70,0x72,0x69,0x6d,0x61,0x72,0x79,0x20,0x6b,0x65,0x79,0x20,0x21,0x21,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x65,0x67,0x65,0x72,0x20,0x50,0x52,0x49,0x4d,0x41,0x52,0x59,0x20,0x4b,0x45,0x59,0x20,0x4e,0x4f,0x54,0x20,0x4e,0x55,0x4c,0x4c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x73,0x75,0x5f,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x63,0x72,0x65,0x61,0x74,0x6f,0x72,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x72,0x74,0x69,0x73,0x74,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x72,0x74,0x69,0x73,0x74,0x5f,0x75,0x6e,0x69,0x63,0x6f,0x64,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x69,0x74,0x6c,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x69,0x74,0x6c,0x65,0x5f,0x75,0x6e,0x69,0x63,0x6f,0x64,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x73,0x70,0x6c,0x61,0x79,0x5f,0x66,0x6f,0x6e,0x74,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x61,0x67,0x73,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x6f,0x75,0x72,0x63,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x72,0x65,0x63,0x74,0x6f,0x72,0x79,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x74,0x61,0x74,0x75,0x73,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x0a,0x29,0x3b,0x0a,0x0a,0x43,0x52,0x45,0x41,0x54,0x45,0x20,0x54,0x41,0x42,0x4c,0x45,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x0a,0x28,0x0a,0x2d,0x2d,0x20,0x64,0x6f,0x20,0x6e,0x6f,0x74,0x20,0x72,0x65,0x70,0x6c,0x61,0x63,0x65,0x20,0x69,0x6e,0x74,0x65,0x67,0x65,0x72,0x20,0x62,0x79,0x20,0x69,0x6e,0x74,0x20,0x66,0x6f,0x72,0x20,0x70,0x72,0x69,0x6d,0x61,0x72,0x79,0x20,0x6b,0x65,0x79,0x20,0x21,0x21,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x69,0x64,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x65,0x67,0x65,0x72,0x20,0x50,0x52,0x49,0x4d,0x41,0x52,0x59,0x20,0x4b,0x45,0x59,0x20,0x4e,0x4f,0x54,0x20,0x4e,0x55,0x4c,0x4c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x73,0x75,0x5f,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x69,0x64,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x73,0x75,0x5f,0x66,0x6f,0x72,0x75,0x6d,0x5f,0x74,0x68,0x72,0x64,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x67,0x61,0x6d,0x65,0x5f,0x6d,0x6f,0x64,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x75,0x64,0x69,0x6f,0x5f,0x66,0x69,0x6c,0x65,0x6e,0x61,0x6d,0x65,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x66,0x66,0x5f,0x6e,0x61,0x6d,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6d,0x64,0x35,0x5f,0x68,0x61,0x73,0x68,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x20,0x55,0x4e,0x49,0x51,0x55,0x45,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x73,0x75,0x5f,0x66,0x69,0x6c,0x65,0x6e,0x61,0x6d,0x65,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x66,0x69,0x6c,0x65,0x5f,0x70,0x61,0x74,0x68,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x63,0x69,0x72,0x63,0x6c,0x65,0x73,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x6c,0x69,0x64,0x65,0x72,0x73,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x70,0x69,0x6e,0x6e,0x65,0x72,0x73,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6c,0x61,0x73,0x74,0x5f,0x6d,0x6f,0x64,0x69,0x66,0x69,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6c,0x61,0x73,0x74,0x5f,0x63,0x68,0x65,0x63,0x6b,0x65,0x64,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x70,0x70,0x72,0x6f,0x61,0x63,0x68,0x5f,0x72,0x61,0x74,0x65,0x20,0x20,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x63,0x69,0x72,0x63,0x6c,0x65,0x5f,0x73,0x69,0x7a,0x65,0x20,0x20,0x20,0x20,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x68,0x70,0x5f,0x64,0x72,0x61,0x69,0x6e,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x76,0x65,0x72,0x61,0x6c,0x6c,0x5f,0x64,0x69,0x66,0x66,0x20,0x20,0x20,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x6c,0x69,0x64,0x65,0x72,0x5f,0x76,0x65,0x6c,0x6f,0x63,0x69,0x74,0x79,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x74,0x61,0x63,0x6b,0x5f,0x6c,0x65,0x6e,0x69,0x65,0x6e,0x63,0x79,0x20,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x72,0x61,0x69,0x6e,0x5f,0x74,0x69,0x6d,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x6f,0x74,0x61,0x6c,0x5f,0x74,0x69,0x6d,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x70,0x72,0x65,0x76,0x69,0x65,0x77,0x5f,0x74,0x69,0x6d,0x65,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x70,0x6d,0x5f,0x61,0x76,0x67,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x70,0x6d,0x5f,0x6d,0x61,0x78,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x70,0x6d,0x5f,0x6d,0x69,0x6e,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6c,0x6f,0x63,0x61,0x6c,0x5f,0x6f,0x66,0x66,0x73,0x65,0x74,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x6e,0x6c,0x69,0x6e,0x65,0x5f,0x6f,0x66,0x66,0x73,0x65,0x74,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x6c,0x72,0x65,0x61,0x64,0x79,0x5f,0x70,0x6c,0x61,0x79,0x65,0x64,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6c,0x61,0x73,0x74,0x5f,0x70,0x6c,0x61,0x79,0x65,0x64,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x67,0x6e,0x6f,0x72,0x65,0x5f,0x68,0x69,0x74,0x73,0x6f,0x75,0x6e,0x64,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x67,0x6e,0x6f,0x72,0x65,0x5f,0x73,0x6b,0x69,0x6e,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x73,0x61,0x62,0x6c,0x65,0x5f,0x73,0x62,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x73,0x61,0x62,0x6c,0x65,0x5f,0x76,0x69,0x64,0x65,0x6f,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x76,0x69,0x73,0x75,0x61,0x6c,0x5f,0x6f,0x76,0x65,0x72,0x72,0x69,0x64,0x65,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6d,0x61,0x6e,0x69,0x61,0x5f,0x73,0x63,0x72,0x6f,0x6c,0x6c,0x5f,0x73,0x70,0x65,0x65,0x64,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x46,0x4f,0x52,0x45,0x49,0x47,0x4e,0x20,0x4b,0x45,0x59,0x28,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x29,0x20,0x52,0x45,0x46,0x45,0x52,0x45,0x4e,0x43,0x45,0x53,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x28,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x29,0x20,0x20,0x0a,0x29,0x3b,0x0a,0};
+const unsigned char _beatmap_db_data[] = {0x0a,0x44,0x52,0x4f,0x50,0x20,0x54,0x41,0x42,0x4c,0x45,0x20,0x49,0x46,0x20,0x45,0x58,0x49,0x53,0x54,0x53,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x3b,0x0a,0x44,0x52,0x4f,0x50,0x20,0x54,0x41,0x42,0x4c,0x45,0x20,0x49,0x46,0x20,0x45,0x58,0x49,0x53,0x54,0x53,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x3b,0x0a,0x0a,0x43,0x52,0x45,0x41,0x54,0x45,0x20,0x54,0x41,0x42,0x4c,0x45,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x0a,0x28,0x0a,0x2d,0x2d,0x20,0x64,0x6f,0x20,0x6e,0x6f,0x74,0x20,0x72,0x65,0x70,0x6c,0x61,0x63,0x65,0x20,0x69,0x6e,0x74,0x65,0x67,0x65,0x72,0x20,0x62,0x79,0x20,0x69,0x6e,0x74,0x20,0x66,0x6f,0x72,0x20,0x70,0x72,0x69,0x6d,0x61,0x72,0x79,0x20,0x6b,0x65,0x79,0x20,0x21,0x21,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x65,0x67,0x65,0x72,0x20,0x50,0x52,0x49,0x4d,0x41,0x52,0x59,0x20,0x4b,0x45,0x59,0x20,0x4e,0x4f,0x54,0x20,0x4e,0x55,0x4c,0x4c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x73,0x75,0x5f,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x63,0x72,0x65,0x61,0x74,0x6f,0x72,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x72,0x74,0x69,0x73,0x74,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x72,0x74,0x69,0x73,0x74,0x5f,0x75,0x6e,0x69,0x63,0x6f,0x64,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x69,0x74,0x6c,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x69,0x74,0x6c,0x65,0x5f,0x75,0x6e,0x69,0x63,0x6f,0x64,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x73,0x70,0x6c,0x61,0x79,0x5f,0x66,0x6f,0x6e,0x74,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x61,0x67,0x73,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x6f,0x75,0x72,0x63,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x72,0x65,0x63,0x74,0x6f,0x72,0x79,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x74,0x61,0x74,0x75,0x73,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x2d,0x2d,0x20,0x61,0x67,0x67,0x72,0x65,0x67,0x61,0x74,0x65,0x64,0x20,0x6f,0x76,0x65,0x72,0x20,0x74,0x68,0x65,0x20,0x64,0x69,0x66,0x66,0x69,0x63,0x75,0x6c,0x74,0x69,0x65,0x73,0x20,0x6f,0x66,0x20,0x74,0x68,0x65,0x20,0x73,0x65,0x74,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x66,0x66,0x69,0x63,0x75,0x6c,0x74,0x79,0x5f,0x63,0x6f,0x75,0x6e,0x74,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x70,0x6d,0x5f,0x6d,0x69,0x6e,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x70,0x6d,0x5f,0x6d,0x61,0x78,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x62,0x6a,0x65,0x63,0x74,0x5f,0x63,0x6f,0x75,0x6e,0x74,0x5f,0x6d,0x69,0x6e,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x62,0x6a,0x65,0x63,0x74,0x5f,0x63,0x6f,0x75,0x6e,0x74,0x5f,0x6d,0x61,0x78,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x72,0x61,0x69,0x6e,0x5f,0x74,0x69,0x6d,0x65,0x5f,0x6d,0x69,0x6e,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x72,0x61,0x69,0x6e,0x5f,0x74,0x69,0x6d,0x65,0x5f,0x6d,0x61,0x78,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x0a,0x29,0x3b,0x0a,0x0a,0x43,0x52,0x45,0x41,0x54,0x45,0x20,0x54,0x41,0x42,0x4c,0x45,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x0a,0x28,0x0a,0x2d,0x2d,0x20,0x64,0x6f,0x20,0x6e,0x6f,0x74,0x20,0x72,0x65,0x70,0x6c,0x61,0x63,0x65,0x20,0x69,0x6e,0x74,0x65,0x67,0x65,0x72,0x20,0x62,0x79,0x20,0x69,0x6e,0x74,0x20,0x66,0x6f,0x72,0x20,0x70,0x72,0x69,0x6d,0x61,0x72,0x79,0x20,0x6b,0x65,0x79,0x20,0x21,0x21,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x69,0x64,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x65,0x67,0x65,0x72,0x20,0x50,0x52,0x49,0x4d,0x41,0x52,0x59,0x20,0x4b,0x45,0x59,0x20,0x4e,0x4f,0x54,0x20,0x4e,0x55,0x4c,0x4c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x73,0x75,0x5f,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x69,0x64,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x73,0x75,0x5f,0x66,0x6f,0x72,0x75,0x6d,0x5f,0x74,0x68,0x72,0x64,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x67,0x61,0x6d,0x65,0x5f,0x6d,0x6f,0x64,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x75,0x64,0x69,0x6f,0x5f,0x66,0x69,0x6c,0x65,0x6e,0x61,0x6d,0x65,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x66,0x66,0x5f,0x6e,0x61,0x6d,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6d,0x64,0x35,0x5f,0x68,0x61,0x73,0x68,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x6c,0x6f,0x62,0x2c,0x20,0x2d,0x2d,0x20,0x31,0x36,0x20,0x62,0x79,0x74,0x65,0x73,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x73,0x75,0x5f,0x66,0x69,0x6c,0x65,0x6e,0x61,0x6d,0x65,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x66,0x69,0x6c,0x65,0x5f,0x70,0x61,0x74,0x68,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x66,0x69,0x6c,0x65,0x5f,0x73,0x69,0x7a,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x63,0x69,0x72,0x63,0x6c,0x65,0x73,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x6c,0x69,0x64,0x65,0x72,0x73,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x70,0x69,0x6e,0x6e,0x65,0x72,0x73,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6c,0x61,0x73,0x74,0x5f,0x6d,0x6f,0x64,0x69,0x66,0x69,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6c,0x61,0x73,0x74,0x5f,0x63,0x68,0x65,0x63,0x6b,0x65,0x64,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x70,0x70,0x72,0x6f,0x61,0x63,0x68,0x5f,0x72,0x61,0x74,0x65,0x20,0x20,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x63,0x69,0x72,0x63,0x6c,0x65,0x5f,0x73,0x69,0x7a,0x65,0x20,0x20,0x20,0x20,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x68,0x70,0x5f,0x64,0x72,0x61,0x69,0x6e,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x76,0x65,0x72,0x61,0x6c,0x6c,0x5f,0x64,0x69,0x66,0x66,0x20,0x20,0x20,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x6c,0x69,0x64,0x65,0x72,0x5f,0x76,0x65,0x6c,0x6f,0x63,0x69,0x74,0x79,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x74,0x61,0x63,0x6b,0x5f,0x6c,0x65,0x6e,0x69,0x65,0x6e,0x63,0x79,0x20,0x20,0x72,0x65,0x61,0x6c,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x72,0x61,0x69,0x6e,0x5f,0x74,0x69,0x6d,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x74,0x6f,0x74,0x61,0x6c,0x5f,0x74,0x69,0x6d,0x65,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x70,0x72,0x65,0x76,0x69,0x65,0x77,0x5f,0x74,0x69,0x6d,0x65,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x70,0x6d,0x5f,0x61,0x76,0x67,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x70,0x6d,0x5f,0x6d,0x61,0x78,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x70,0x6d,0x5f,0x6d,0x69,0x6e,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6c,0x6f,0x63,0x61,0x6c,0x5f,0x6f,0x66,0x66,0x73,0x65,0x74,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6f,0x6e,0x6c,0x69,0x6e,0x65,0x5f,0x6f,0x66,0x66,0x73,0x65,0x74,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x61,0x6c,0x72,0x65,0x61,0x64,0x79,0x5f,0x70,0x6c,0x61,0x79,0x65,0x64,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6c,0x61,0x73,0x74,0x5f,0x70,0x6c,0x61,0x79,0x65,0x64,0x20,0x20,0x20,0x20,0x20,0x74,0x65,0x78,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x67,0x6e,0x6f,0x72,0x65,0x5f,0x68,0x69,0x74,0x73,0x6f,0x75,0x6e,0x64,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x67,0x6e,0x6f,0x72,0x65,0x5f,0x73,0x6b,0x69,0x6e,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x73,0x61,0x62,0x6c,0x65,0x5f,0x73,0x62,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x69,0x73,0x61,0x62,0x6c,0x65,0x5f,0x76,0x69,0x64,0x65,0x6f,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x76,0x69,0x73,0x75,0x61,0x6c,0x5f,0x6f,0x76,0x65,0x72,0x72,0x69,0x64,0x65,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x6d,0x61,0x6e,0x69,0x61,0x5f,0x73,0x63,0x72,0x6f,0x6c,0x6c,0x5f,0x73,0x70,0x65,0x65,0x64,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x2c,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x46,0x4f,0x52,0x45,0x49,0x47,0x4e,0x20,0x4b,0x45,0x59,0x28,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x29,0x20,0x52,0x45,0x46,0x45,0x52,0x45,0x4e,0x43,0x45,0x53,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x28,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x29,0x20,0x20,0x0a,0x29,0x3b,0x0a,0x0a,0x2d,0x2d,0x20,0x68,0x61,0x73,0x68,0x20,0x6c,0x6f,0x6f,0x6b,0x75,0x70,0x73,0x20,0x61,0x72,0x65,0x20,0x61,0x6e,0x73,0x77,0x65,0x72,0x65,0x64,0x20,0x66,0x72,0x6f,0x6d,0x20,0x74,0x68,0x65,0x20,0x69,0x6e,0x64,0x65,0x78,0x20,0x61,0x6c,0x6f,0x6e,0x65,0x0a,0x43,0x52,0x45,0x41,0x54,0x45,0x20,0x49,0x4e,0x44,0x45,0x58,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x6d,0x64,0x35,0x5f,0x68,0x61,0x73,0x68,0x20,0x4f,0x4e,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x28,0x6d,0x64,0x35,0x5f,0x68,0x61,0x73,0x68,0x2c,0x20,0x66,0x69,0x6c,0x65,0x5f,0x70,0x61,0x74,0x68,0x2c,0x20,0x67,0x61,0x6d,0x65,0x5f,0x6d,0x6f,0x64,0x65,0x29,0x3b,0x0a,0x43,0x52,0x45,0x41,0x54,0x45,0x20,0x49,0x4e,0x44,0x45,0x58,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x20,0x4f,0x4e,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x28,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x69,0x64,0x29,0x3b,0x0a,0x43,0x52,0x45,0x41,0x54,0x45,0x20,0x55,0x4e,0x49,0x51,0x55,0x45,0x20,0x49,0x4e,0x44,0x45,0x58,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x5f,0x64,0x69,0x72,0x65,0x63,0x74,0x6f,0x72,0x79,0x20,0x4f,0x4e,0x20,0x62,0x65,0x61,0x74,0x6d,0x61,0x70,0x5f,0x73,0x65,0x74,0x28,0x64,0x69,0x72,0x65,0x63,0x74,0x6f,0x72,0x79,0x29,0x3b,0x0a,0x0a,0x50,0x52,0x41,0x47,0x4d,0x41,0x20,0x75,0x73,0x65,0x72,0x5f,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x35,0x3b,0x0a,0};
 const unsigned long _beatmap_db_length = sizeof _beatmap_db_data;
\ No newline at end of file
@@ -0,0 +1,204 @@
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <glib.h>
+
+#include "osux/beatmap_db_server.h"
+#include "osux/error.h"
+
+#define READ_CHUNK_SIZE 4096
+// requests sent ahead of the replies in resolve_many; small enough for
+// the replies to never reach the server's output limit
+#define PIPELINE_DEPTH 128
+
+int osux_beatmap_db_client_connect(osux_beatmap_db_client *client,
+                                   char const *socket_path)
+{
+    struct sockaddr_un addr;
+    memset(client, 0, sizeof *client);
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof addr.sun_path)
+        return -OSUX_ERR_INVAL;
+    strcpy(addr.sun_path, socket_path);
+
+    client->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client->fd < 0)
+        return -OSUX_ERR_SOCKET;
+    if (connect(client->fd, (struct sockaddr*) &addr, sizeof addr) < 0) {
+        close(client->fd);
+        client->fd = -1;
+        return -OSUX_ERR_SOCKET;
+    }
+    client->input = g_string_new(NULL);
+    return 0;
+}
+
+void osux_beatmap_db_client_close(osux_beatmap_db_client *client)
+{
+    if (client->fd >= 0)
+        close(client->fd);
+    if (client->input != NULL)
+        g_string_free(client->input, TRUE);
+    memset(client, 0, sizeof *client);
+    client->fd = -1;
+}
+
+static int send_request(osux_beatmap_db_client *client,
+                        char const *request, char const *arg)
+{
+    if (strchr(arg, '\n') != NULL)
+        return -OSUX_ERR_INVAL;
+
+    char *line = g_strdup_printf("%s %s\n", request, arg);
+    size_t length = strlen(line), sent = 0;
+    while (sent < length) {
+        ssize_t size = send(client->fd, line + sent, length - sent, MSG_NOSIGNAL);
+        if (size < 0 && errno == EINTR)
+            continue;
+        if (size < 0) {
+            g_free(line);
+            return -OSUX_ERR_SOCKET;
+        }
+        sent += size;
+    }
+    g_free(line);
+    return 0;
+}
+
+// the next line received, without its newline; NULL on error
+static char *read_line(osux_beatmap_db_client *client)
+{
+    char *nl;
+    while ((nl = memchr(client->input->str, '\n', client->input->len)) == NULL) {
+        char buf[READ_CHUNK_SIZE];
+        ssize_t size = recv(client->fd, buf, sizeof buf, 0);
+        if (size < 0 && errno == EINTR)
+            continue;
+        if (size <= 0)
+            return NULL;
+        g_string_append_len(client->input, buf, size);
+    }
+    gsize length = nl - client->input->str;
+    char *line = g_strndup(client->input->str, length);
+    g_string_erase(client->input, 0, length + 1);
+    return line;
+}
+
+/*
+ * lines of the next reply, as a NULL terminated array;
+ * NULL when the server refused the request or the connection failed
+ */
+static char **read_reply(osux_beatmap_db_client *client)
+{
+    char *status = read_line(client);
+    if (status == NULL)
+        return NULL;
+    if (status[0] != '+') {
+        osux_debug("server: %s\n", status + (status[0] == '-'));
+        g_free(status);
+        return NULL;
+    }
+
+    unsigned count = strtoul(status + 1, NULL, 10);
+    g_free(status);
+    char **lines = g_new0(char*, count + 1);
+    for (unsigned i = 0; i < count; ++i) {
+        if ((lines[i] = read_line(client)) == NULL) {
+            g_strfreev(lines);
+            return NULL;
+        }
+    }
+    return lines;
+}
+
+static char **query(osux_beatmap_db_client *client,
+                    char const *request, char const *arg)
+{
+    if (send_request(client, request, arg) < 0)
+        return NULL;
+    return read_reply(client);
+}
+
+// first line of a reply, NULL if there is none
+static char *take_first_line(char **lines)
+{
+    char *first = lines != NULL ? g_strdup(lines[0]) : NULL;
+    g_strfreev(lines);
+    return first;
+}
+
+char *osux_beatmap_db_client_get_path_by_hash(osux_beatmap_db_client *client,
+                                              char const *md5_hash)
+{
+    return take_first_line(query(client, "hash", md5_hash));
+}
+
+unsigned osux_beatmap_db_client_resolve_many(osux_beatmap_db_client *client,
+                                             char const *const *hashes,
+                                             unsigned count, char **out_paths)
+{
+    unsigned sent = 0, found = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        while (sent < count && sent < i + PIPELINE_DEPTH) {
+            if (send_request(client, "hash", hashes[sent]) < 0)
+                // still send something, replies are matched by position
+                send_request(client, "hash", "");
+            ++ sent;
+        }
+        out_paths[i] = take_first_line(read_reply(client));
+        found += out_paths[i] != NULL;
+    }
+    return found;
+}
+
+char **osux_beatmap_db_client_get_set_paths_by_hash(
+    osux_beatmap_db_client *client, char const *md5_hash)
+{
+    char **paths = query(client, "set", md5_hash);
+    if (paths != NULL && paths[0] == NULL) {
+        g_strfreev(paths);
+        return NULL;
+    }
+    return paths;
+}
+
+osux_hashtable *osux_beatmap_db_client_get_metadata(
+    osux_beatmap_db_client *client, char const *file_path)
+{
+    char **lines = query(client, "path", file_path);
+    if (lines == NULL || lines[0] == NULL) {
+        g_strfreev(lines);
+        return NULL;
+    }
+
+    osux_hashtable *metadata = osux_hashtable_new_full(0, &g_free);
+    for (unsigned i = 0; lines[i] != NULL; ++i) {
+        char *tab = strchr(lines[i], '\t');
+        if (tab == NULL)
+            continue;
+        *tab = '\0';
+        osux_hashtable_insert(metadata, lines[i], g_strdup(tab + 1));
+    }
+    g_strfreev(lines);
+    return metadata;
+}
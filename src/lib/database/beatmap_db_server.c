@@ -0,0 +1,304 @@
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <glib.h>
+
+#include "osux/beatmap_db_server.h"
+#include "osux/error.h"
+#include "osux/util.h"
+
+#define READ_CHUNK_SIZE 4096
+// a request line longer than this closes the connection
+#define MAX_REQUEST_LENGTH 4096
+// stop reading requests from a client while that much is waiting to be sent
+#define OUTPUT_HIGH_WATER (1 << 20)
+
+typedef struct server_client_ {
+    int fd;
+    GString *input;
+    GString *output;
+    gsize output_sent;
+    bool closing; // end of input, close once the output is sent
+} server_client;
+
+static int set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        return -OSUX_ERR_SOCKET;
+    return 0;
+}
+
+/*
+ * A socket left behind by a server that did not exit cleanly refuses
+ * connections: only that one is removed, never a live server's socket
+ * or a file that is not a socket.
+ */
+static int remove_stale_socket(struct sockaddr_un const *addr)
+{
+    struct stat st;
+    if (lstat(addr->sun_path, &st) < 0)
+        return errno == ENOENT ? 0 : -OSUX_ERR_SOCKET;
+    if (!S_ISSOCK(st.st_mode))
+        return -OSUX_ERR_SOCKET;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -OSUX_ERR_SOCKET;
+    int ret = connect(fd, (struct sockaddr const*) addr, sizeof *addr);
+    int connect_errno = errno;
+    close(fd);
+    if (ret < 0 && connect_errno == ECONNREFUSED) {
+        if (unlink(addr->sun_path) < 0 && errno != ENOENT)
+            return -OSUX_ERR_SOCKET;
+        return 0;
+    }
+    return -OSUX_ERR_SOCKET;
+}
+
+static int listen_on(char const *socket_path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof addr.sun_path)
+        return -OSUX_ERR_INVAL;
+    strcpy(addr.sun_path, socket_path);
+
+    if (remove_stale_socket(&addr) < 0) {
+        osux_error("%s: address already in use\n", socket_path);
+        return -OSUX_ERR_SOCKET;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -OSUX_ERR_SOCKET;
+    if (bind(fd, (struct sockaddr*) &addr, sizeof addr) < 0 ||
+        listen(fd, SOMAXCONN) < 0 || set_nonblocking(fd) < 0) {
+        osux_error("%s: %s\n", socket_path, strerror(errno));
+        close(fd);
+        return -OSUX_ERR_SOCKET;
+    }
+    return fd;
+}
+
+static void client_free(server_client *client)
+{
+    close(client->fd);
+    g_string_free(client->input, TRUE);
+    g_string_free(client->output, TRUE);
+    g_free(client);
+}
+
+static void reply_paths(GString *out, char **paths)
+{
+    g_string_append_printf(out, "+%u\n", paths ? g_strv_length(paths) : 0);
+    for (unsigned i = 0; paths != NULL && paths[i] != NULL; ++i)
+        g_string_append_printf(out, "%s\n", paths[i]);
+}
+
+typedef struct metadata_reply_ {
+    GString *lines;
+    unsigned count;
+} metadata_reply;
+
+static int append_metadata(osux_database_row const *row, void *user_data)
+{
+    metadata_reply *reply = user_data;
+    int col_count = osux_database_column_count(row);
+    for (int i = 0; i < col_count; ++i) {
+        char const *value = osux_database_column_text(row, i);
+        if (value == NULL)
+            continue;
+        g_string_append_printf(reply->lines, "%s\t%s\n",
+                               osux_database_column_name(row, i), value);
+        ++ reply->count;
+    }
+    return 1;
+}
+
+static void handle_request(osux_beatmap_db *db, char *line, GString *out)
+{
+    char *arg = strchr(line, ' ');
+    if (arg == NULL) {
+        g_string_append(out, "-missing argument\n");
+        return;
+    }
+    *arg++ = '\0';
+
+    if (!strcmp(line, "hash")) {
+        char *path = osux_beatmap_db_get_path_by_hash(db, arg);
+        char *paths[] = { path, NULL };
+        reply_paths(out, paths);
+        g_free(path);
+    } else if (!strcmp(line, "set")) {
+        char **paths = osux_beatmap_db_get_set_paths_by_hash(db, arg);
+        reply_paths(out, paths);
+        g_strfreev(paths);
+    } else if (!strcmp(line, "path")) {
+        metadata_reply reply = { g_string_new(NULL), 0 };
+        if (osux_beatmap_db_foreach_metadata_by_path(
+                db, arg, &append_metadata, &reply) < 0) {
+            g_string_append(out, "-database error\n");
+        } else {
+            g_string_append_printf(out, "+%u\n", reply.count);
+            g_string_append_len(out, reply.lines->str, reply.lines->len);
+        }
+        g_string_free(reply.lines, TRUE);
+    } else {
+        g_string_append(out, "-unknown request\n");
+    }
+}
+
+// answer every complete line received; false if the client misbehaves
+static bool handle_input(osux_beatmap_db *db, server_client *client)
+{
+    gsize start = 0;
+    char *nl;
+    while ((nl = memchr(client->input->str + start, '\n',
+                        client->input->len - start)) != NULL) {
+        *nl = '\0';
+        char *line = client->input->str + start;
+        if (nl > line && nl[-1] == '\r')
+            nl[-1] = '\0';
+        handle_request(db, line, client->output);
+        start = nl + 1 - client->input->str;
+    }
+    g_string_erase(client->input, 0, start);
+    return client->input->len <= MAX_REQUEST_LENGTH;
+}
+
+// false when the connection must be closed
+static bool client_read(osux_beatmap_db *db, server_client *client)
+{
+    char buf[READ_CHUNK_SIZE];
+    ssize_t size = read(client->fd, buf, sizeof buf);
+    if (size < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    if (size == 0) {
+        client->closing = true;
+        return true;
+    }
+    g_string_append_len(client->input, buf, size);
+    return handle_input(db, client);
+}
+
+static bool client_write(server_client *client)
+{
+    ssize_t size = send(client->fd, client->output->str + client->output_sent,
+                        client->output->len - client->output_sent, MSG_NOSIGNAL);
+    if (size < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    client->output_sent += size;
+    if (client->output_sent == client->output->len) {
+        g_string_truncate(client->output, 0);
+        client->output_sent = 0;
+    }
+    return true;
+}
+
+static void accept_clients(int listen_fd, GPtrArray *clients)
+{
+    int fd;
+    while ((fd = accept(listen_fd, NULL, NULL)) >= 0) {
+        if (set_nonblocking(fd) < 0) {
+            close(fd);
+            continue;
+        }
+        server_client *client = g_new0(server_client, 1);
+        client->fd = fd;
+        client->input = g_string_new(NULL);
+        client->output = g_string_new(NULL);
+        g_ptr_array_add(clients, client);
+    }
+}
+
+static short client_events(server_client const *client)
+{
+    short events = 0;
+    if (!client->closing && client->output->len < OUTPUT_HIGH_WATER)
+        events |= POLLIN;
+    if (client->output->len > 0)
+        events |= POLLOUT;
+    return events;
+}
+
+int osux_beatmap_db_serve(osux_beatmap_db *db, char const *socket_path,
+                          sig_atomic_t volatile const *stop)
+{
+    int listen_fd = listen_on(socket_path);
+    if (listen_fd < 0)
+        return listen_fd;
+
+    GPtrArray *clients = g_ptr_array_new_with_free_func(
+        (GDestroyNotify) &client_free);
+    GArray *fds = g_array_new(FALSE, FALSE, sizeof(struct pollfd));
+    int err = 0;
+
+    while (stop == NULL || !*stop) {
+        struct pollfd listener = { listen_fd, POLLIN, 0 };
+        g_array_set_size(fds, 0);
+        g_array_append_val(fds, listener);
+        for (unsigned i = 0; i < clients->len; ++i) {
+            server_client *client = clients->pdata[i];
+            struct pollfd pfd = { client->fd, client_events(client), 0 };
+            g_array_append_val(fds, pfd);
+        }
+
+        if (poll((struct pollfd*) fds->data, fds->len, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            err = -OSUX_ERR_SOCKET;
+            break;
+        }
+
+        // clients accepted now are polled from the next iteration
+        unsigned polled = clients->len;
+        if (g_array_index(fds, struct pollfd, 0).revents & POLLIN)
+            accept_clients(listen_fd, clients);
+
+        for (unsigned i = polled; i-- > 0; ) {
+            server_client *client = clients->pdata[i];
+            short revents = g_array_index(fds, struct pollfd, i + 1).revents;
+            bool keep = true;
+
+            if (!client->closing && (revents & (POLLIN | POLLHUP)))
+                keep = client_read(db, client);
+            if (keep && (revents & POLLOUT))
+                keep = client_write(client);
+            if (revents & POLLERR)
+                keep = false;
+            if (client->closing && client->output->len == 0)
+                keep = false;
+            if (!keep)
+                g_ptr_array_remove_index_fast(clients, i);
+        }
+    }
+
+    g_array_free(fds, TRUE);
+    g_ptr_array_free(clients, TRUE);
+    close(listen_fd);
+    unlink(socket_path);
+    return err;
+}
@@ -34,37 +34,110 @@ static sqlite3 *get_handle(osux_database *db)
     return db->file_handle;
 }
 
-int osux_database_exec_prepared_query(osux_database *db, osux_list *query_result)
+struct osux_database_row_ {
+    sqlite3_stmt *stmt;
+};
+
+int osux_database_column_count(osux_database_row const *row)
 {
-    int ret = sqlite3_step(db->prepared_query);
+    return sqlite3_data_count(row->stmt);
+}
 
-    while (ret != SQLITE_DONE) {
-        if (ret != SQLITE_ROW) {
-            osux_debug("%s\n", sqlite3_errmsg(get_handle(db)));
-            sqlite3_reset(db->prepared_query);
-            sqlite3_clear_bindings(db->prepared_query);
-            return -OSUX_ERR_DATABASE;
-        }
-        osux_hashtable *dict = osux_hashtable_new(0);
+char const *osux_database_column_name(osux_database_row const *row, int col)
+{
+    return sqlite3_column_name(row->stmt, col);
+}
 
-        int col_count = sqlite3_data_count(db->prepared_query);
-        for (int i = 0; i < col_count; ++i) {
-            char const *col_text;
-            col_text = (char const*) sqlite3_column_text(db->prepared_query, i);
+bool osux_database_column_is_null(osux_database_row const *row, int col)
+{
+    return sqlite3_column_type(row->stmt, col) == SQLITE_NULL;
+}
 
-            if (col_text != NULL) {
-                char const *col_name = sqlite3_column_name(db->prepared_query, i);
-                osux_hashtable_insert(dict, col_name, g_strdup(col_text));
-            }
-        }
-        osux_list_append(query_result, dict);
-        ret = sqlite3_step(db->prepared_query);
+int64_t osux_database_column_int64(osux_database_row const *row, int col)
+{
+    return sqlite3_column_int64(row->stmt, col);
+}
+
+double osux_database_column_double(osux_database_row const *row, int col)
+{
+    return sqlite3_column_double(row->stmt, col);
+}
+
+char const *osux_database_column_text(osux_database_row const *row, int col)
+{
+    return (char const*) sqlite3_column_text(row->stmt, col);
+}
+
+void const *osux_database_column_blob(osux_database_row const *row, int col,
+                                      int *size)
+{
+    void const *blob = sqlite3_column_blob(row->stmt, col);
+    *size = sqlite3_column_bytes(row->stmt, col);
+    return blob;
+}
+
+static int step_rows(sqlite3_stmt *stmt,
+                     osux_database_row_fn callback, void *user_data)
+{
+    osux_database_row row = { stmt };
+    int ret;
+
+    while ((ret = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (callback != NULL && (*callback)(&row, user_data) != 0)
+            return 0;
     }
+    if (ret != SQLITE_DONE) {
+        osux_debug("%s\n", sqlite3_errmsg(sqlite3_db_handle(stmt)));
+        return -OSUX_ERR_DATABASE;
+    }
+    return 0;
+}
+
+int osux_database_foreach_prepared_row(
+    osux_database *db, osux_database_row_fn callback, void *user_data)
+{
+    int err = step_rows(db->prepared_query, callback, user_data);
     sqlite3_reset(db->prepared_query);
     sqlite3_clear_bindings(db->prepared_query);
+    return err;
+}
+
+int osux_database_foreach_row(osux_database *db, char const *query,
+                              osux_database_row_fn callback, void *user_data)
+{
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(get_handle(db), query, -1, &stmt, NULL) != SQLITE_OK) {
+        osux_debug("%s\n", sqlite3_errmsg(get_handle(db)));
+        return -OSUX_ERR_DATABASE;
+    }
+    int err = step_rows(stmt, callback, user_data);
+    sqlite3_finalize(stmt);
+    return err;
+}
+
+static int append_row(osux_database_row const *row, void *user_data)
+{
+    osux_list *query_result = user_data;
+    osux_hashtable *dict = osux_hashtable_new(0);
+
+    int col_count = osux_database_column_count(row);
+    for (int i = 0; i < col_count; ++i) {
+        char const *col_text = osux_database_column_text(row, i);
+        if (col_text != NULL) {
+            char const *col_name = osux_database_column_name(row, i);
+            osux_hashtable_insert(dict, col_name, g_strdup(col_text));
+        }
+    }
+    osux_list_append(query_result, dict);
     return 0;
 }
 
+int osux_database_exec_prepared_query(osux_database *db, osux_list *query_result)
+{
+    return osux_database_foreach_prepared_row(
+        db, query_result != NULL ? &append_row : NULL, query_result);
+}
+
 int osux_database_exec_query(
     osux_database *db, char const *query, osux_list *query_result)
 {
@@ -92,9 +165,13 @@ int osux_database_print_query(osux_database *db, char const *query, FILE *out)
     return 0;
 }
 
-int osux_database_bind_int(osux_database *db, char const *name, int i)
+int osux_database_parameter_index(osux_database *db, char const *name)
+{
+    return sqlite3_bind_parameter_index(db->prepared_query, name);
+}
+
+int osux_database_bind_int_at(osux_database *db, int index, int i)
 {
-    int index = sqlite3_bind_parameter_index(db->prepared_query, name);
     if (sqlite3_bind_int(db->prepared_query, index, i) != SQLITE_OK) {
         osux_debug("%s\n", sqlite3_errmsg(get_handle(db)));
         return -OSUX_ERR_DATABASE;
@@ -102,9 +179,17 @@ int osux_database_bind_int(osux_database *db, char const *name, int i)
     return 0;
 }
 
-int osux_database_bind_double(osux_database *db, char const *name, double d)
+int osux_database_bind_int64_at(osux_database *db, int index, int64_t i)
+{
+    if (sqlite3_bind_int64(db->prepared_query, index, i) != SQLITE_OK) {
+        osux_debug("%s\n", sqlite3_errmsg(get_handle(db)));
+        return -OSUX_ERR_DATABASE;
+    }
+    return 0;
+}
+
+int osux_database_bind_double_at(osux_database *db, int index, double d)
 {
-    int index = sqlite3_bind_parameter_index(db->prepared_query, name);
     if (sqlite3_bind_double(db->prepared_query, index, d) != SQLITE_OK) {
         osux_debug("%s\n", sqlite3_errmsg(get_handle(db)));
         return -OSUX_ERR_DATABASE;
@@ -112,6 +197,43 @@ int osux_database_bind_double(osux_database *db, char const *name, double d)
     return 0;
 }
 
+int osux_database_bind_string_at(osux_database *db, int index, char const *str)
+{
+    if (sqlite3_bind_text(db->prepared_query, index, str, -1, SQLITE_STATIC) != SQLITE_OK) {
+        osux_debug("%s\n", sqlite3_errmsg(get_handle(db)));
+        return -OSUX_ERR_DATABASE;
+    }
+    return 0;
+}
+
+int osux_database_bind_blob_at(osux_database *db, int index,
+                               void const *data, int size)
+{
+    if (sqlite3_bind_blob(db->prepared_query, index, data, size, SQLITE_TRANSIENT) != SQLITE_OK) {
+        osux_debug("%s\n", sqlite3_errmsg(get_handle(db)));
+        return -OSUX_ERR_DATABASE;
+    }
+    return 0;
+}
+
+int osux_database_bind_int(osux_database *db, char const *name, int i)
+{
+    return osux_database_bind_int_at(
+        db, osux_database_parameter_index(db, name), i);
+}
+
+int osux_database_bind_int64(osux_database *db, char const *name, int64_t i)
+{
+    return osux_database_bind_int64_at(
+        db, osux_database_parameter_index(db, name), i);
+}
+
+int osux_database_bind_double(osux_database *db, char const *name, double d)
+{
+    return osux_database_bind_double_at(
+        db, osux_database_parameter_index(db, name), d);
+}
+
 int osux_database_bind_string(osux_database *db, char const *name, char const *str)
 {
     int index = sqlite3_bind_parameter_index(db->prepared_query, name);
@@ -122,81 +244,152 @@ int osux_database_bind_string(osux_database *db, char const *name, char const *s
     return 0;
 }
 
-static int load_or_save_memory(osux_database *db, bool is_save)
+struct osux_database_stmt_ {
+    sqlite3_stmt *stmt;
+};
+
+static void statement_free(osux_database_stmt *stmt)
 {
-    sqlite3_backup *pBackup;  /* Backup object used to copy data */
-    sqlite3 *pTo;             /* Database to copy to (pFile or pInMemory) */
-    sqlite3 *pFrom;           /* Database to copy from (pFile or pInMemory) */
+    sqlite3_finalize(stmt->stmt);
+    g_free(stmt);
+}
 
-    pFrom = (is_save ? db->mem_handle  : db->file_handle);
-    pTo   = (is_save ? db->file_handle : db->mem_handle);
+osux_database_stmt *osux_database_statement(osux_database *db,
+                                            char const *query)
+{
+    osux_database_stmt *stmt = g_hash_table_lookup(db->statements, query);
+    if (stmt != NULL)
+        return stmt;
 
-    pBackup = sqlite3_backup_init(pTo, "main", pFrom, "main");
-    if (pBackup) {
-        (void) sqlite3_backup_step(pBackup, -1);
-        (void) sqlite3_backup_finish(pBackup);
+    sqlite3_stmt *sqlite_stmt;
+    if (sqlite3_prepare_v2(get_handle(db), query, -1,
+                           &sqlite_stmt, NULL) != SQLITE_OK) {
+        osux_debug("%s\n", sqlite3_errmsg(get_handle(db)));
+        return NULL;
     }
-    return sqlite3_errcode(pTo);
+    stmt = g_new(osux_database_stmt, 1);
+    stmt->stmt = sqlite_stmt;
+    g_hash_table_insert(db->statements, g_strdup(query), stmt);
+    return stmt;
 }
 
-static void save_from_memory(osux_database *db)
+void osux_database_use_statement(osux_database *db, osux_database_stmt *stmt)
 {
-    if (db->in_memory) {
-        load_or_save_memory(db, true);
-        sqlite3_close(db->mem_handle);
-        db->mem_handle = NULL;
-        db->in_memory = false;
+    // statements are reset after execution, this only drops a half read one
+    sqlite3_reset(stmt->stmt);
+    db->prepared_query = stmt->stmt;
+}
+
+int osux_database_prepare_query(osux_database *db, char const *query)
+{
+    osux_database_stmt *stmt = osux_database_statement(db, query);
+    if (stmt == NULL)
+        return -OSUX_ERR_DATABASE;
+    osux_database_use_statement(db, stmt);
+    return 0;
+}
+
+// pages copied per backup step when writing the in-memory copy back
+#define SAVE_PAGES_PER_STEP 256
+// pragmas applied to file connections (lookups then read through the mmap)
+#define FILE_PRAGMAS                            \
+    "PRAGMA mmap_size = 268435456;"             \
+    "PRAGMA cache_size = -16384;"
+
+static int copy_database(sqlite3 *from, sqlite3 *to, int pages_per_step)
+{
+    sqlite3_backup *backup = sqlite3_backup_init(to, "main", from, "main");
+    if (backup == NULL) {
+        osux_debug("%s\n", sqlite3_errmsg(to));
+        return -OSUX_ERR_DATABASE;
     }
+
+    int ret;
+    do {
+        ret = sqlite3_backup_step(backup, pages_per_step);
+        if (ret == SQLITE_BUSY || ret == SQLITE_LOCKED)
+            sqlite3_sleep(10);
+    } while (ret == SQLITE_OK || ret == SQLITE_BUSY || ret == SQLITE_LOCKED);
+    sqlite3_backup_finish(backup);
+
+    if (ret != SQLITE_DONE) {
+        osux_debug("%s\n", sqlite3_errstr(ret));
+        return -OSUX_ERR_DATABASE;
+    }
+    return 0;
 }
 
-static int load_to_memory(osux_database *db)
+static int load_to_memory(osux_database *db, bool empty)
 {
-    if (!db->in_memory) {
-        int ret = sqlite3_open(":memory:", &db->mem_handle);
-        if (ret) {
-            osux_debug("%s\n", sqlite3_errmsg(db->mem_handle));
-            sqlite3_close(db->mem_handle);
-            return -OSUX_ERR_DATABASE;
-        }
-        load_or_save_memory(db, false);
-        db->in_memory = true;
+    int ret = sqlite3_open(":memory:", &db->mem_handle);
+    if (ret) {
+        osux_debug("%s\n", sqlite3_errmsg(db->mem_handle));
+        sqlite3_close(db->mem_handle);
+        db->mem_handle = NULL;
+        return -OSUX_ERR_DATABASE;
     }
+    if (!empty &&
+        (ret = copy_database(db->file_handle, db->mem_handle, -1)) < 0) {
+        sqlite3_close(db->mem_handle);
+        db->mem_handle = NULL;
+        return ret;
+    }
+    db->in_memory = true;
     return 0;
 }
 
-int osux_database_init(osux_database *db, char const *file_path)
+int osux_database_open(osux_database *db, char const *file_path, int flags)
 {
     memset(db, 0, sizeof *db);
+    if ((flags & OSUX_DATABASE_IN_MEMORY) && (flags & OSUX_DATABASE_READ_ONLY))
+        return -OSUX_ERR_INVAL;
+
     db->in_memory = false;
+    db->read_only = (flags & OSUX_DATABASE_READ_ONLY) != 0;
+    db->file_path = g_strdup(file_path);
+    db->statements = g_hash_table_new_full(
+        g_str_hash, g_str_equal, g_free, (GDestroyNotify) statement_free);
 
-    int ret = sqlite3_open(file_path, &db->file_handle);
+    int open_flags = db->read_only ? SQLITE_OPEN_READONLY :
+        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+    int ret = sqlite3_open_v2(file_path, &db->file_handle, open_flags, NULL);
     if (ret) {
         osux_debug("%s\n", sqlite3_errmsg(db->file_handle));
-        sqlite3_close(db->file_handle);
+        osux_database_free(db);
         return -OSUX_ERR_DATABASE;
     }
-    if ((ret = load_to_memory(db)) < 0)
-        return ret;
+    // only a performance hint: ignore the failure
+    sqlite3_exec(db->file_handle, FILE_PRAGMAS, NULL, NULL, NULL);
+
+    if (flags & OSUX_DATABASE_IN_MEMORY) {
+        ret = load_to_memory(db, (flags & OSUX_DATABASE_EMPTY) != 0);
+        if (ret < 0) {
+            osux_database_free(db);
+            return ret;
+        }
+    }
     return 0;
 }
 
-void osux_database_free(osux_database *db)
+int osux_database_init(osux_database *db, char const *file_path)
 {
-    if (db->in_memory)
-        save_from_memory(db);
-    sqlite3_finalize(db->prepared_query);
-    sqlite3_close(db->file_handle);
+    return osux_database_open(db, file_path, 0);
 }
 
-int osux_database_prepare_query(osux_database *db, char const *query)
+int osux_database_save(osux_database *db)
 {
-    sqlite3_finalize(db->prepared_query);
+    if (!db->in_memory)
+        return 0;
+    return copy_database(db->mem_handle, db->file_handle, SAVE_PAGES_PER_STEP);
+}
 
-    int ret = sqlite3_prepare_v2(get_handle(db), query, -1,
-                             &db->prepared_query, NULL);
-    if (ret != SQLITE_OK) {
-        osux_debug("%s\n", sqlite3_errmsg(get_handle(db)));
-        return -OSUX_ERR_DATABASE;
-    }
-    return 0;
+void osux_database_free(osux_database *db)
+{
+    if (db->statements != NULL)
+        g_hash_table_destroy(db->statements);
+    if (db->in_memory)
+        sqlite3_close(db->mem_handle);
+    sqlite3_close(db->file_handle);
+    g_free(db->file_path);
+    memset(db, 0, sizeof *db);
 }
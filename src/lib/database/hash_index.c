@@ -0,0 +1,206 @@
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "osux/error.h"
+#include "osux/hash_index.h"
+
+#define HASH_INDEX_MAGIC "OSHI"
+#define HASH_INDEX_VERSION 2
+#define HASH_INDEX_BYTE_ORDER 0x01020304
+
+typedef struct hash_index_header_ {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t entry_count;
+    uint32_t pool_size;
+    osux_hash_index_source source;
+} hash_index_header;
+
+bool osux_md5_hash_to_digest(char const *md5_hash,
+                             uint8_t digest[OSUX_HASH_INDEX_DIGEST_LENGTH])
+{
+    if (md5_hash == NULL)
+        return false;
+    for (unsigned i = 0; i < OSUX_HASH_INDEX_DIGEST_LENGTH; ++i) {
+        int high = g_ascii_xdigit_value(md5_hash[2*i]);
+        int low = high < 0 ? -1 : g_ascii_xdigit_value(md5_hash[2*i+1]);
+        if (low < 0)
+            return false;
+        digest[i] = (high << 4) | low;
+    }
+    return md5_hash[2*OSUX_HASH_INDEX_DIGEST_LENGTH] == '\0';
+}
+
+void osux_hash_index_init(osux_hash_index *index)
+{
+    memset(index, 0, sizeof *index);
+}
+
+void osux_hash_index_free(osux_hash_index *index)
+{
+    g_free(index->entries);
+    g_free(index->pool);
+    memset(index, 0, sizeof *index);
+}
+
+int osux_hash_index_add(osux_hash_index *index,
+                        char const *md5_hash, char const *path)
+{
+    uint8_t digest[OSUX_HASH_INDEX_DIGEST_LENGTH];
+    if (!osux_md5_hash_to_digest(md5_hash, digest))
+        return -OSUX_ERR_INVAL;
+    return osux_hash_index_add_digest(index, digest, path);
+}
+
+int osux_hash_index_add_digest(
+    osux_hash_index *index,
+    uint8_t const digest[OSUX_HASH_INDEX_DIGEST_LENGTH], char const *path)
+{
+    osux_hash_index_entry entry;
+    size_t length = strlen(path) + 1;
+
+    memcpy(entry.digest, digest, sizeof entry.digest);
+    if (length > UINT32_MAX - index->pool_size)
+        return -OSUX_ERR_INVAL;
+
+    if (index->entry_count == index->entry_bufsize) {
+        index->entry_bufsize = index->entry_bufsize ? 2 * index->entry_bufsize : 256;
+        index->entries = g_renew(osux_hash_index_entry, index->entries,
+                                 index->entry_bufsize);
+    }
+    while (index->pool_size + length > index->pool_bufsize) {
+        index->pool_bufsize = index->pool_bufsize ? 2 * index->pool_bufsize : 4096;
+        index->pool = g_realloc(index->pool, index->pool_bufsize);
+    }
+
+    entry.path_offset = index->pool_size;
+    memcpy(index->pool + index->pool_size, path, length);
+    index->pool_size += length;
+    index->entries[index->entry_count++] = entry;
+    return 0;
+}
+
+static int compare_entry(void const *a, void const *b)
+{
+    return memcmp(a, b, OSUX_HASH_INDEX_DIGEST_LENGTH);
+}
+
+void osux_hash_index_sort(osux_hash_index *index)
+{
+    qsort(index->entries, index->entry_count,
+          sizeof *index->entries, &compare_entry);
+}
+
+char const *osux_hash_index_lookup(osux_hash_index const *index,
+                                   char const *md5_hash)
+{
+    osux_hash_index_entry key;
+    if (!osux_md5_hash_to_digest(md5_hash, key.digest))
+        return NULL;
+
+    osux_hash_index_entry const *entry = bsearch(
+        &key, index->entries, index->entry_count,
+        sizeof *index->entries, &compare_entry);
+    return entry != NULL ? index->pool + entry->path_offset : NULL;
+}
+
+int osux_hash_index_save(osux_hash_index const *index, char const *path)
+{
+    hash_index_header header;
+    size_t entries_size = index->entry_count * sizeof *index->entries;
+
+    memset(&header, 0, sizeof header);
+    memcpy(header.magic, HASH_INDEX_MAGIC, sizeof header.magic);
+    header.version = HASH_INDEX_VERSION;
+    header.byte_order = HASH_INDEX_BYTE_ORDER;
+    header.entry_count = index->entry_count;
+    header.pool_size = index->pool_size;
+    header.source = index->source;
+
+    GString *data = g_string_sized_new(
+        sizeof header + entries_size + index->pool_size);
+    g_string_append_len(data, (gchar*) &header, sizeof header);
+    g_string_append_len(data, (gchar*) index->entries, entries_size);
+    g_string_append_len(data, index->pool, index->pool_size);
+
+    // written to a temporary file and renamed: never seen half written
+    gboolean saved = g_file_set_contents(path, data->str, data->len, NULL);
+    g_string_free(data, TRUE);
+    return saved ? 0 : -OSUX_ERR_FILE_ERROR;
+}
+
+static bool hash_index_is_valid(osux_hash_index const *index)
+{
+    if (index->pool_size > 0 && index->pool[index->pool_size - 1] != '\0')
+        return false;
+    for (uint32_t i = 0; i < index->entry_count; ++i) {
+        if (index->entries[i].path_offset >= index->pool_size)
+            return false;
+        if (i > 0 && compare_entry(&index->entries[i-1],
+                                   &index->entries[i]) > 0)
+            return false;
+    }
+    return true;
+}
+
+int osux_hash_index_load(osux_hash_index *index, char const *path)
+{
+    gchar *data;
+    gsize size;
+    hash_index_header header;
+
+    osux_hash_index_init(index);
+    if (!g_file_get_contents(path, &data, &size, NULL))
+        return -OSUX_ERR_FILE_ACCESS;
+
+    int err = -OSUX_ERR_INVALID_BINARY;
+    if (size < sizeof header)
+        goto finally;
+    memcpy(&header, data, sizeof header);
+    if (memcmp(header.magic, HASH_INDEX_MAGIC, sizeof header.magic) != 0)
+        goto finally;
+    if (header.version != HASH_INDEX_VERSION ||
+        header.byte_order != HASH_INDEX_BYTE_ORDER) {
+        err = -OSUX_ERR_BINARY_VERSION;
+        goto finally;
+    }
+
+    size_t entries_size = header.entry_count * sizeof *index->entries;
+    if (header.entry_count > size / sizeof *index->entries ||
+        size != sizeof header + entries_size + header.pool_size)
+        goto finally;
+
+    index->source = header.source;
+    index->entry_count = index->entry_bufsize = header.entry_count;
+    index->entries = g_memdup(data + sizeof header, entries_size);
+    index->pool_size = index->pool_bufsize = header.pool_size;
+    index->pool = g_memdup(data + sizeof header + entries_size,
+                           header.pool_size);
+    if (!hash_index_is_valid(index)) {
+        osux_hash_index_free(index);
+        goto finally;
+    }
+    err = 0;
+
+finally:
+    g_free(data);
+    return err;
+}
@@ -1,3 +1,4 @@
+#include <string.h>
 #include <glib.h>
 
 #include "osux/error.h"
@@ -11,57 +12,100 @@
             return err_macro_;                  \
     } while (0)
 
+// first byte of a present string
+#define STRING_PRESENT 0x0B
 
-ssize_t osux_buffer_reader_read(osux_buffer_reader *br, void *data, size_t size)
+int osux_buffer_reader_read_view(osux_buffer_reader *br, size_t size,
+                                 osux_buffer_view *view)
 {
-    if (br->r + size > br->size)
+    if (size > osux_buffer_reader_left(br))
         return -OSUX_ERR_BUFFER_READER_RANGE;
-    memcpy(data, br->data+br->r, size);
+    view->ptr = (char const*) br->data + br->r;
+    view->len = size;
     br->r += size;
+    return 0;
+}
+
+ssize_t osux_buffer_reader_read(osux_buffer_reader *br, void *data, size_t size)
+{
+    osux_buffer_view view;
+    CHK( osux_buffer_reader_read_view(br, size, &view) );
+    memcpy(data, view.ptr, size);
     return size;
 }
 
 int osux_buffer_reader_read_uleb128(osux_buffer_reader *br, uint64_t *value)
 {
-    *value = 0;
+    uint64_t r = br->r;
     unsigned shift = 0;
     uint8_t p;
+    *value = 0;
     do {
-        CHK( osux_buffer_reader_read(br, &p, sizeof p) );
+        int err = osux_buffer_reader_read_u8(br, &p);
+        if (err < 0 || shift >= 64) {
+            br->r = r;
+            return -OSUX_ERR_BUFFER_READER_RANGE;
+        }
         *value += (uint64_t) (p & 0x7f) << shift;
         shift += 7;
     } while (p >= 0x80);
     return 0;
 }
 
+int osux_buffer_reader_read_string_view(osux_buffer_reader *br,
+                                        osux_buffer_view *view)
+{
+    uint64_t r = br->r;
+    uint8_t head;
+    int err;
+
+    view->ptr = NULL;
+    view->len = 0;
+    CHK( osux_buffer_reader_read_u8(br, &head) );
+    if (head != STRING_PRESENT)
+        return 0;
+
+    uint64_t length;
+    if ((err = osux_buffer_reader_read_uleb128(br, &length)) < 0 ||
+        (err = osux_buffer_reader_read_view(br, length, view)) < 0)
+        br->r = r;
+    return err;
+}
+
 int osux_buffer_reader_read_string(osux_buffer_reader *br, char **p_str)
 {
-    int err = 0;
     if (p_str == NULL)
         return -OSUX_ERR_INVAL;
 
-    uint8_t head;
-    CHK( osux_buffer_reader_read(br, &head, sizeof head) );
-    if (head == 0x0B) {
-        uint64_t uleb_size;
-        CHK( osux_buffer_reader_read_uleb128(br, &uleb_size) );
-        *p_str = g_malloc(uleb_size+1);
-        CHK( osux_buffer_reader_read(br, *p_str, uleb_size) );
-        (*p_str)[uleb_size] = 0;
-    }
-    return err;
+    osux_buffer_view view;
+    CHK( osux_buffer_reader_read_string_view(br, &view) );
+    if (view.ptr != NULL)
+        *p_str = g_strndup(view.ptr, view.len);
+    return 0;
+}
+
+int osux_buffer_reader_skip_string(osux_buffer_reader *br)
+{
+    osux_buffer_view view;
+    return osux_buffer_reader_read_string_view(br, &view);
 }
 
 int osux_buffer_reader_read_lzma(
     osux_buffer_reader *br, char **value, size_t size)
 {
+    osux_buffer_view stream;
+    CHK( osux_buffer_reader_read_view(br, size, &stream) );
+
     size_t out_len = 0;
-    lzma_decompress(br->data+br->r, size, (uint8_t**) value, &out_len);
-    br->r += out_len;
+    lzma_decompress((uint8_t const*) stream.ptr, stream.len,
+                    (uint8_t**) value, &out_len);
+    if (*value == NULL)
+        return -OSUX_ERR_REPLAY_DATA;
     return 0;
 }
 
-int osux_buffer_reader_init(osux_buffer_reader *br, void *data, size_t size)
+int osux_buffer_reader_init(osux_buffer_reader *br,
+                            void const *data, size_t size)
 {
     memset(br, 0, sizeof*br);
     br->data = data;
@@ -1,6 +1,11 @@
+#include <stdarg.h>
+
 #include "osux/hit.h"
+#include "osux/hit_analysis.h"
 #include "osux/error.h"
+#include "osux/compiler.h"
 #include "osux/keys.h"
+#include "osux/hitsound.h"
 #include "osux/replay.h"
 #include "osux/beatmap.h"
 
@@ -87,15 +92,64 @@ void osux_get_hit_windows(
     }
 }
 
-static void print_hit_windows(double window[])
+// taiko: GREAT in 50 - 3*OD, GOOD in 120 - 8*OD (110 - 6*OD from OD 5)
+static double taiko_good_window(double od)
 {
-    for (unsigned i = 0; i < MAX_HIT_TYPE; ++i)
-        printf("hit_window '%s': %g\n", hit_str[i], window[i]);
+    return od < 5. ? 120. - 8. * od : 110. - 6. * od;
+}
+
+void osux_get_taiko_hit_windows(double window[], double od, int mods)
+{
+    if (mods & MOD_EASY)
+        od /= 2.;
+    else if (mods & MOD_HARDROCK)
+        od = min(10., 1.4 * od);
+
+    double great = 50. - 3. * od;
+    double good = taiko_good_window(od);
+    // taiko only has GREAT, GOOD and miss: a press past GOOD hits nothing
+    window[HIT_RAINBOW_300] = great;
+    window[HIT_300] = great;
+    window[HIT_200] = good;
+    window[HIT_100] = good;
+    window[HIT_50] = good;
+    window[HIT_MISS] = good;
+
+    for (unsigned iHit = 0; iHit < MAX_HIT_TYPE; ++iHit) {
+        if (mods & MOD_DOUBLETIME)
+            window[iHit] *= TWO_THIRD;
+        else if (mods & MOD_HALFTIME)
+            window[iHit] *= FOUR_THIRD;
+    }
 }
 
+static void hits_debug(osux_hits const *h, char const *format, ...)
+    G_GNUC_PRINTF(2, 3);
 
-#define HIT_KEY_DIFF(d1, d2)                                    \
-    (HIT_KEY_PRESSED((d1)->keys) ^ HIT_KEY_PRESSED((d2)->keys))
+// formats the line only when someone listens
+static void hits_debug(osux_hits const *h, char const *format, ...)
+{
+    if (h->debug == NULL)
+        return;
+
+    va_list ap;
+    va_start(ap, format);
+    char *line = g_strdup_vprintf(format, ap);
+    va_end(ap);
+    (*h->debug)(line, h->debug_data);
+    g_free(line);
+}
+
+void osux_hits_print_debug(char const *line, void *user_data)
+{
+    fprintf(user_data, "%s\n", line);
+}
+
+static void debug_hit_windows(osux_hits const *h)
+{
+    for (unsigned i = 0; i < MAX_HIT_TYPE; ++i)
+        hits_debug(h, "hit_window '%s': %g", hit_str[i], h->window[i]);
+}
 
 static int get_hit_type_std(double window[], int64_t distance)
 {
@@ -115,16 +169,23 @@ static int get_hit_type_taiko(double window[], int64_t distance)
 {
     distance = labs(distance);
 
-    if (distance < window[HIT_300])
+    if (distance <= window[HIT_300])
         return HIT_300;
-    else if (distance < window[HIT_50])
+    else if (distance <= window[HIT_100])
         return HIT_100;
     else
         return HIT_MISS;
 }
 
-static inline int64_t time_distance(osux_keypress *kp, osux_hitobject *ho)
+// past every hit window: the distance when there is no key press left
+#define NO_KEYPRESS_DISTANCE INT32_MAX
+
+static inline int64_t time_distance(osux_keypress const *kp,
+                                    osux_keypress const *end,
+                                    osux_hitobject const *ho)
 {
+    if (kp == end)
+        return NO_KEYPRESS_DISTANCE;
     return (int64_t) kp->offset - ho->offset;
 }
 
@@ -134,163 +195,258 @@ static int cmp_time_offset(void const *a, void const *b)
         ((osux_replay_data const*)b)->time_offset;
 }
 
-static void print_time_offset_human_readable(int64_t offset)
+static char *keypress_str(osux_keypress const *kp)
 {
-    int64_t minutes, seconds, milliseconds;
+    int64_t offset, minutes, seconds, milliseconds;
+    offset = kp->offset;
     milliseconds = offset % 1000;
     offset /= 1000;
     seconds = offset % 60;
     minutes = offset / 60;
-    printf("%ld: %ldm %lds.%03ld", offset*1000+milliseconds,
-           minutes, seconds, milliseconds);
+    return g_strdup_printf("%ld: %ldm %lds.%03ld | key=%u -- %s",
+                           kp->offset, minutes, seconds, milliseconds,
+                           kp->key, kp->release ? "RELEASE" : "PRESS");
 }
 
-// return value's nth set bit, all other bits are zeroed
-static uint32_t get_nth_bit_set(uint32_t value, unsigned n)
+static int osux_hits_compute_data(
+    osux_hits *h, osux_replay_data const *data, size_t data_count)
 {
-    unsigned shift = 0;
-    while (n > 0) {
+    ALLOC_ARRAY(h->data, h->data_count, data_count-2);
+    COPY_ARRAY(h->data+1, data+2, data_count-3); // evict first, second and last
+    qsort(h->data+1, h->data_count-1, sizeof*data, &cmp_time_offset);
+    memset(h->data, 0, sizeof*data); // zero first element
+    return 0;
+}
+
+// frames whose key changes are looked for together
+#define KEY_BLOCK 64
 
-        if (value & 1)
-            n--;
-        value >>= 1;
-        ++ shift;
+// hit keys changed since the previous frame, 0 for the first one
+static unsigned compute_key_diffs(uint16_t const *keys, size_t count,
+                                  uint8_t *diff)
+{
+    unsigned event_count = 0;
+    if (count == 0)
+        return 0;
+    diff[0] = 0;
+    // branch free, so that the compiler can vectorize it
+    for (size_t i = 1; i < count; ++i) {
+        diff[i] = HIT_KEY_PRESSED(keys[i] ^ keys[i-1]);
+        event_count += osux_popcount32(diff[i]);
     }
-    return 1U << (shift-1);
+    return event_count;
 }
 
-static unsigned bit_set_count(uint32_t value)
+/*
+ * A keyboard key also flags the mouse button it is bound to (this is why
+ * the mouse cannot click while those keys are pressed): in standard,
+ * the second event of such a pair is the same key press.
+ */
+static inline bool is_double_keypress(osux_keypress const *prev,
+                                      osux_keypress const *kp)
 {
-    unsigned count = 0;
-    for (unsigned i = 0; i < 32; ++i)
-        if ((value >> i) & 1)
-            ++ count;
-    return count;
+    unsigned or_key = prev->key | kp->key;
+    return prev->offset == kp->offset && prev->release == kp->release
+        && (or_key == KEY_LEFT || or_key == KEY_RIGHT);
 }
 
-// remove double keypress in standart difficulties replay
-// these double appear because keyboard hit key will also flag as
-// mouse hit key (this is the reason why you cant click with mouse when
-// your mouse keys are pressed
-static void keypress_remove_doubles(osux_hits *h)
+/*
+ * Press/release events of each hit key, lowest key bit first for events
+ * at the same time. Only the frames with a change are visited: blocks
+ * of KEY_BLOCK frames are turned into a bit mask of changed frames.
+ */
+static void extract_keypress(osux_hits *h, int64_t const *times,
+                             uint16_t const *keys, size_t count)
 {
-    if ((h->game_mode != GAME_MODE_STD && h->game_mode != GAME_MODE_TAIKO)
-        || !h->keypress_count)
-        return;
+    // taiko keys are distinct: both dons at once is a strong hit
+    bool remove_doubles = h->game_mode == GAME_MODE_STD;
+    uint8_t *diff = g_new(uint8_t, count);
+    unsigned event_count = compute_key_diffs(keys, count, diff);
+    osux_keypress prev = { .offset = INT64_MIN };
+
+    // never NULL, even without any event
+    h->keypress = g_new(osux_keypress, MAX(event_count, 1));
+    h->keypress_count = 0;
 
-    osux_keypress *unique_kp;
-    size_t unique_kp_size;
-    osux_keypress *kp = h->keypress;
-
-    ALLOC_ARRAY(unique_kp, unique_kp_size, h->keypress_count);
-    unique_kp_size = 1;
-    // copy the first one
-    memcpy(&unique_kp[0], &kp[0], sizeof*kp);
-
-    for (unsigned i = 1; i < h->keypress_count; ++i) {
-        unsigned or_key = kp[i].key | kp[i-1].key;
-        if ((kp[i].offset == kp[i-1].offset) &&
-            (kp[i].release == kp[i-1].release) &&
-            (or_key == KEY_LEFT || or_key == KEY_RIGHT)) {
-            // skip if this is the same keypress
-            continue;
+    for (size_t block = 0; block < count; block += KEY_BLOCK) {
+        size_t block_size = min(count - block, (size_t) KEY_BLOCK);
+        uint64_t changed = 0;
+        for (size_t j = 0; j < block_size; ++j)
+            changed |= (uint64_t) (diff[block + j] != 0) << j;
+
+        while (changed != 0) {
+            size_t i = block + osux_ctz64(changed);
+            changed &= changed - 1;
+
+            for (uint32_t d = diff[i]; d != 0; d &= d - 1) {
+                osux_keypress kp;
+                kp.offset = times[i];
+                kp.key = d & -d;
+                kp.release = !(kp.key & keys[i]);
+                bool skip = remove_doubles && is_double_keypress(&prev, &kp);
+                prev = kp;
+                if (!skip)
+                    h->keypress[h->keypress_count++] = kp;
+            }
         }
-        memcpy(&unique_kp[unique_kp_size], &kp[i], sizeof*kp);
-        ++ unique_kp_size;
     }
-
-    g_free(h->keypress);
-    h->keypress = unique_kp;
-    h->keypress_count = unique_kp_size;
+    g_free(diff);
 }
 
-static int osux_hits_compute_data(
-    osux_hits *h, osux_replay_data const *data, size_t data_count)
+static int osux_hits_compute_keypress(osux_hits *h)
 {
-    ALLOC_ARRAY(h->data, h->data_count, data_count-2);
-    COPY_ARRAY(h->data+1, data+2, data_count-3); // evict first, second and last
-    qsort(h->data+1, h->data_count-1, sizeof*data, &cmp_time_offset);
-    memset(h->data, 0, sizeof*data); // zero first element
+    // key and time columns of the sorted frames
+    int64_t *times = g_new(int64_t, h->data_count);
+    uint16_t *keys = g_new(uint16_t, h->data_count);
+    for (size_t i = 0; i < h->data_count; ++i) {
+        times[i] = h->data[i].time_offset;
+        keys[i] = h->data[i].keys;
+    }
+    extract_keypress(h, times, keys, h->data_count);
+    g_free(times);
+    g_free(keys);
     return 0;
 }
 
-static int osux_hits_compute_keypress(osux_hits *h)
+typedef struct timed_keys_ {
+    int64_t time;
+    uint16_t keys;
+} timed_keys;
+
+static int cmp_timed_keys(void const *a, void const *b)
 {
-    size_t keypress_cap;
-    osux_replay_data *data = h->data;
-    h->keypress_count = 0;
-    ALLOC_ARRAY(h->keypress, keypress_cap, 500);
-
-    for (unsigned i = 1; i < h->data_count; ++i) {
-        int keys_diff = HIT_KEY_DIFF(&data[i], &data[i-1]);
-        if (keys_diff != 0) {
-            unsigned key_count = bit_set_count(keys_diff);
-            HANDLE_ARRAY_SIZE(h->keypress,
-                              h->keypress_count+key_count,
-                              keypress_cap);
-            for (unsigned k = 1; k <= key_count; ++k) {
-
-                osux_keypress *kp = &h->keypress[h->keypress_count];
-                kp->offset = data[i].time_offset;
-                kp->key = get_nth_bit_set(keys_diff, k);
-                if (kp->key & data[i].keys)
-                    kp->release = false;
-                else
-                    kp->release = true;
-                ++ h->keypress_count;
-            }
-        }
+    int64_t x = ((timed_keys const*) a)->time;
+    int64_t y = ((timed_keys const*) b)->time;
+    return (x > y) - (x < y);
+}
+
+// frames are sorted by time, except in rare replays
+static void sort_frames(int64_t *times, uint16_t *keys, size_t count)
+{
+    size_t i = 1;
+    while (i < count && times[i-1] <= times[i])
+        ++ i;
+    if (i >= count)
+        return;
+
+    timed_keys *frames = g_new(timed_keys, count);
+    for (i = 0; i < count; ++i)
+        frames[i] = (timed_keys) { times[i], keys[i] };
+    qsort(frames, count, sizeof*frames, &cmp_timed_keys);
+    for (i = 0; i < count; ++i) {
+        times[i] = frames[i].time;
+        keys[i] = frames[i].keys;
     }
-    keypress_remove_doubles(h);
+    g_free(frames);
+}
+
+/*
+ * Same as osux_hits_compute_data followed by osux_hits_compute_keypress,
+ * for a replay loaded with OSUX_REPLAY_FRAME_COLUMNS (h->data stays NULL)
+ */
+static int osux_hits_compute_keypress_frames(
+    osux_hits *h, osux_replay_frames const *frames)
+{
+    size_t count = frames->count - 2;
+    int64_t *times = g_new(int64_t, count);
+    uint16_t *keys = g_new(uint16_t, count);
+
+    // evict first, second and last
+    osux_replay_frames_times(frames, 2, count - 1, times + 1);
+    memcpy(keys + 1, frames->keys + 2, (count - 1) * sizeof keys[0]);
+    sort_frames(times + 1, keys + 1, count - 1);
+    times[0] = 0; // zero first element
+    keys[0] = 0;
+
+    extract_keypress(h, times, keys, count);
+    g_free(times);
+    g_free(keys);
     return 0;
 }
 
-void osux_hits_print_keypress(osux_hits *h)
+void osux_hits_print_keypress(osux_hits const *h, FILE *f)
 {
     for (unsigned i = 0; i < h->keypress_count; ++i) {
-        osux_keypress *kp = &h->keypress[i];
-        print_time_offset_human_readable(kp->offset);
-        printf(" | key=%u -- %s\n", kp->key, kp->release ? "RELEASE" : "PRESS");
+        char *str = keypress_str(&h->keypress[i]);
+        fprintf(f, "%s\n", str);
+        g_free(str);
     }
 }
 
+static void debug_keypress(osux_hits const *h)
+{
+    if (h->debug == NULL)
+        return;
+    for (unsigned i = 0; i < h->keypress_count; ++i) {
+        char *str = keypress_str(&h->keypress[i]);
+        (*h->debug)(str, h->debug_data);
+        g_free(str);
+    }
+}
+
+static void set_hit(osux_hit *hit, osux_hit_type type, osux_keypress const *kp,
+                    int64_t distance)
+{
+    hit->hit_type = type;
+    hit->hitted = true;
+    hit->timed = true;
+    hit->distance = distance;
+    hit->key = kp->key;
+}
+
+static void set_free_hit(osux_hit *hit)
+{
+    hit->hit_type = HIT_300;
+    hit->hitted = true;
+}
+
+static void debug_hit(osux_hits const *h, osux_hit const *hit,
+                      osux_keypress const *kp, osux_keypress const *end,
+                      osux_hitobject const *ho, int64_t distance)
+{
+    if (kp == end)
+        hits_debug(h, "hit %s no key press left, ho_offset=%ld",
+                   hit_str[hit->hit_type], ho->offset);
+    else
+        hits_debug(h, "hit %s distance=%ld, hit_offset=%ld, ho_offset=%ld",
+                   hit_str[hit->hit_type], distance, kp->offset, ho->offset);
+}
+
 // basic hit computation for standard mode:
 // all spinner / slider are free 300's
 // only timing is currently taken into account; no position
 static int osux_hits_compute_hits_std_basic(
     osux_hits *h, osux_beatmap const *beatmap)
 {
-    double window[MAX_HIT_TYPE];
+    double *window = h->window;
     osux_keypress *p_keypress = h->keypress;
     osux_keypress *keypresses_end = h->keypress + h->keypress_count;
     osux_hitobject *p_hitobject;
     osux_hitobject *hitobjects_end = beatmap->hitobjects + beatmap->hitobject_count;
     int i_hitobject;
-    int64_t max_distance = 0;
 
-    osux_get_hit_windows(window, h->overall_difficulty, h->mods);
-    ALLOC_ARRAY(h->hits, h->hits_size, beatmap->hitobject_count);
+    h->hits = g_new0(osux_hit, beatmap->hitobject_count);
+    h->hits_size = beatmap->hitobject_count;
 
     for ( p_hitobject = &beatmap->hitobjects[0], i_hitobject = 0;
           p_hitobject != hitobjects_end;
           ++ p_hitobject, ++ i_hitobject   )
     {
-        int64_t distance = time_distance( p_keypress, p_hitobject );
-        max_distance = max(max_distance, labs(distance));
+        osux_hit *hit = &h->hits[i_hitobject];
+        int64_t distance = time_distance(p_keypress, keypresses_end, p_hitobject);
 
         // get first key press in (miss) hit window
         while ((p_keypress != keypresses_end && p_keypress->release)
                || distance < -window[HIT_MISS])
         {
             ++ p_keypress;
-            distance = time_distance( p_keypress, p_hitobject );
+            distance = time_distance(p_keypress, keypresses_end, p_hitobject);
         }
 
         // free win spinner
         if (HIT_OBJECT_IS_SPINNER(p_hitobject))
         {
-            h->hits[i_hitobject].hit_type = HIT_300;
-            h->hits[i_hitobject].hitted = true;
+            set_free_hit(hit);
 
             while (p_keypress != keypresses_end &&
                    p_keypress->offset < p_hitobject->end_offset)
@@ -303,130 +459,233 @@ static int osux_hits_compute_hits_std_basic(
 
         // if no keypress in the hit window, that's a miss
         if (distance > window[HIT_50]) {
-            h->hits[i_hitobject].hitted = false;
-            h->hits[i_hitobject].hit_type = HIT_MISS;
+            hit->hitted = false;
+            hit->hit_type = HIT_MISS;
 
             if (distance < window[HIT_MISS] && HIT_OBJECT_IS_SLIDER(p_hitobject))
             {
-                h->hits[i_hitobject].hit_type = HIT_300;
-                h->hits[i_hitobject].hitted = true;
+                set_free_hit(hit);
                 ++ p_keypress;
                 continue;
             }
-            printf("missed 'after' distance=%ld, hit_offset=%ld, ho_offset=%ld\n",
-                   distance, p_keypress->offset, p_hitobject->offset);
+            debug_hit(h, hit, p_keypress, keypresses_end, p_hitobject, distance);
         } else {
-            h->hits[i_hitobject].hitted = true;
             if (HIT_OBJECT_IS_CIRCLE(p_hitobject))
-                h->hits[i_hitobject].hit_type = get_hit_type_std(window, distance);
+                set_hit(hit, get_hit_type_std(window, distance),
+                        p_keypress, distance);
             else
                 // free win slider
-                h->hits[i_hitobject].hit_type = HIT_300;
+                set_hit(hit, HIT_300, p_keypress, distance);
 
-            printf("hit %s distance=%ld, hit_offset=%ld, ho_offset=%ld\n",
-                   hit_str[h->hits[i_hitobject].hit_type], distance,
-                   p_keypress->offset, p_hitobject->offset);
+            debug_hit(h, hit, p_keypress, keypresses_end, p_hitobject, distance);
+            h->max_distance = max(h->max_distance, labs(distance));
             ++ p_keypress;
         }
     }
-
-    print_hit_windows(window);
-    printf("OD: %g\n", beatmap->OverallDifficulty);
-    printf("max_distance: %ld\n", max_distance);
     return 0;
 }
 
-// basic hit computation for taiko mode:
-// drum roll(slider) is ignored
-// shaker (spinner) is free win
-static int osux_hits_compute_hits_taiko_basic(
-    osux_hits *h, osux_beatmap const *beatmap)
+// the second press of a strong hit comes at most that late after the first
+#define TAIKO_STRONG_WINDOW 30
+
+#define TAIKO_DON_KEYS (LEFT_DON | RIGHT_DON)
+#define TAIKO_KAT_KEYS (LEFT_KAT | RIGHT_KAT)
+#define TAIKO_LEFT_KEYS (LEFT_DON | LEFT_KAT)
+
+static unsigned taiko_colour_keys(osux_hitobject const *ho)
 {
-    double window[MAX_HIT_TYPE];
-    osux_keypress *p_keypress = h->keypress;
-    osux_keypress *keypresses_end = h->keypress + h->keypress_count;
-    osux_hitobject *p_hitobject;
-    osux_hitobject *hitobjects_end = beatmap->hitobjects + beatmap->hitobject_count;
-    int i_hitobject;
-    int64_t max_distance = 0;
+    if (ho->hitsound.sample & SAMPLE_TAIKO_KAT)
+        return TAIKO_KAT_KEYS;
+    return TAIKO_DON_KEYS;
+}
 
-    osux_get_hit_windows(window, h->overall_difficulty, h->mods);
-    ALLOC_ARRAY(h->hits, h->hits_size, beatmap->hitobject_count);
+static bool taiko_is_big(osux_hitobject const *ho)
+{
+    return (ho->hitsound.sample & SAMPLE_TAIKO_BIG) != 0;
+}
 
-    for ( p_hitobject = &beatmap->hitobjects[0], i_hitobject = 0;
-          p_hitobject != hitobjects_end;
-          ++ p_hitobject, ++ i_hitobject   )
+static bool taiko_other_hand(osux_keypress const *a, osux_keypress const *b)
+{
+    return !(a->key & TAIKO_LEFT_KEYS) != !(b->key & TAIKO_LEFT_KEYS);
+}
+
+static osux_keypress const *
+next_press(osux_keypress const *kp, osux_keypress const *end)
+{
+    while (kp != end && kp->release)
+        ++ kp;
+    return kp;
+}
+
+// drum roll ticks are 1/4 beats apart, 1/3 beats with a tick rate of 3
+static unsigned taiko_drum_roll_ticks(osux_hitobject const *ho,
+                                      osux_beatmap const *beatmap)
+{
+    if (ho->bpm <= 0.)
+        return 1;
+    double tick_rate = beatmap->SliderTickRate == 3. ? 3. : 4.;
+    double tick_length = 60000. / ho->bpm / tick_rate;
+    return (unsigned) ((ho->end_offset - ho->offset) / tick_length) + 1;
+}
+
+// 3 hits per second at OD 0, 5 at OD 5, 7.5 at OD 10
+static unsigned taiko_shaker_hits(osux_hitobject const *ho,
+                                  osux_beatmap const *beatmap)
+{
+    double od = beatmap->OverallDifficulty;
+    double per_second = od < 5. ? 3. + 2. * od / 5. : 5. + 2.5 * (od - 5.) / 5.;
+    double hits = (ho->end_offset - ho->offset) / 1000. * per_second;
+    return hits < 1. ? 1 : (unsigned) hits;
+}
+
+// any press during a drum roll or a shaker scores, up to 'max'
+static osux_keypress const *
+taiko_bonus(osux_hit *hit, osux_keypress const *kp, osux_keypress const *end,
+            osux_hitobject const *ho, unsigned max)
+{
+    unsigned count = 0;
+    for (kp = next_press(kp, end);
+         kp != end && kp->offset <= ho->end_offset;
+         kp = next_press(kp + 1, end))
     {
-        int64_t distance = time_distance( p_keypress, p_hitobject );
+        if (kp->offset >= ho->offset)
+            ++ count;
+    }
+    hit->bonus_hits = min(count, max);
+    hit->bonus_max = max;
+    return kp;
+}
 
-        // get first key press in (miss) hit window
-        while ((p_keypress != keypresses_end && p_keypress->release)
-               || distance < -window[HIT_50])
-        {
-            ++ p_keypress;
-            distance = time_distance( p_keypress, p_hitobject );
+/*
+ * Taiko judgement: a note is judged by the first press in its hit window;
+ * a press of the wrong colour (don keys on a kat) makes it a miss.
+ * A big note is hit strong when the other hand presses the same colour
+ * right after. Drum roll ticks and shaker hits are counted.
+ */
+static int osux_hits_compute_hits_taiko(
+    osux_hits *h, osux_beatmap const *beatmap)
+{
+    double *window = h->window;
+    osux_keypress const *p_keypress = h->keypress;
+    osux_keypress const *keypresses_end = h->keypress + h->keypress_count;
+
+    h->hits = g_new0(osux_hit, beatmap->hitobject_count);
+    h->hits_size = beatmap->hitobject_count;
+
+    for (unsigned i = 0; i < beatmap->hitobject_count; ++i) {
+        osux_hitobject const *ho = &beatmap->hitobjects[i];
+        osux_hit *hit = &h->hits[i];
+
+        if (HIT_OBJECT_IS_SLIDER(ho) || HIT_OBJECT_IS_SPINNER(ho)) {
+            bool roll = HIT_OBJECT_IS_SLIDER(ho);
+            unsigned max = roll ? taiko_drum_roll_ticks(ho, beatmap)
+                : taiko_shaker_hits(ho, beatmap);
+            p_keypress = taiko_bonus(hit, p_keypress, keypresses_end, ho, max);
+            // a drum roll cannot be failed, a shaker can
+            hit->hitted = roll || hit->bonus_hits == max;
+            hit->hit_type = hit->hitted ? HIT_300 : HIT_MISS;
+            hits_debug(h, "%s %u/%u, ho_offset=%ld",
+                       roll ? "drum roll" : "shaker",
+                       hit->bonus_hits, hit->bonus_max, ho->offset);
+            continue;
         }
 
+        // presses before the hit window hit nothing
+        int64_t distance;
+        p_keypress = next_press(p_keypress, keypresses_end);
+        while ((distance = time_distance(p_keypress, keypresses_end, ho))
+               < -window[HIT_100])
+            p_keypress = next_press(p_keypress + 1, keypresses_end);
+
+        if (distance > window[HIT_100]) {
+            hit->hitted = false;
+            hit->hit_type = HIT_MISS;
+            debug_hit(h, hit, p_keypress, keypresses_end, ho, distance);
+            continue;
+        }
 
-        // free win shaker/spinner
-        if (HIT_OBJECT_IS_SPINNER(p_hitobject) || HIT_OBJECT_IS_SLIDER(p_hitobject))
-        {
-            h->hits[i_hitobject].hit_type = HIT_300;
-            h->hits[i_hitobject].hitted = true;
-
-            while (p_keypress != keypresses_end &&
-                   p_keypress->offset < p_hitobject->end_offset)
-            {
-                // get out of shaker/spinner
-                ++ p_keypress;
-            }
+        unsigned colour = taiko_colour_keys(ho);
+        if (!(p_keypress->key & colour)) {
+            hit->hitted = true;
+            hit->hit_type = HIT_MISS;
+            hit->distance = distance;
+            hit->key = p_keypress->key;
+            hits_debug(h, "hit %s wrong colour key=%u, ho_offset=%ld",
+                       hit_str[hit->hit_type], p_keypress->key, ho->offset);
+            p_keypress = next_press(p_keypress + 1, keypresses_end);
             continue;
         }
 
-        // if no keypress in the hit window, that's a miss
-        if (distance > window[HIT_50]) {
-            h->hits[i_hitobject].hitted = false;
-            h->hits[i_hitobject].hit_type = HIT_MISS;
-            printf("hit %s distance=%ld, hit_offset=%ld, ho_offset=%ld\n",
-                   hit_str[h->hits[i_hitobject].hit_type], distance,
-                   p_keypress->offset, p_hitobject->offset);
-        } else {
-            h->hits[i_hitobject].hitted = true;
-            if (HIT_OBJECT_IS_CIRCLE(p_hitobject)) {
-                h->hits[i_hitobject].hit_type =
-                    get_hit_type_taiko(window, distance);
-            } else
-                // free win slider
-                h->hits[i_hitobject].hit_type = HIT_300;
-            printf("hit %s distance=%ld, hit_offset=%ld, ho_offset=%ld\n",
-                   hit_str[h->hits[i_hitobject].hit_type], distance,
-                   p_keypress->offset, p_hitobject->offset);
+        set_hit(hit, get_hit_type_taiko(window, distance), p_keypress, distance);
+        debug_hit(h, hit, p_keypress, keypresses_end, ho, distance);
+        h->max_distance = max(h->max_distance, labs(distance));
 
-            max_distance = max(max_distance, labs(distance));
-            ++ p_keypress;
+        osux_keypress const *first = p_keypress;
+        p_keypress = next_press(p_keypress + 1, keypresses_end);
+        if (taiko_is_big(ho) && p_keypress != keypresses_end
+            && p_keypress->offset - first->offset <= TAIKO_STRONG_WINDOW
+            && (p_keypress->key & colour)
+            && taiko_other_hand(first, p_keypress))
+        {
+            hit->strong = true;
+            p_keypress = next_press(p_keypress + 1, keypresses_end);
         }
     }
+    return 0;
+}
 
-    print_hit_windows(window);
-    printf("OD: %g\n", beatmap->OverallDifficulty);
-    printf("max_distance: %ld\n", max_distance);
+int osux_hits_taiko_states(osux_hits const *h, osux_beatmap const *beatmap,
+                           osux_taiko_state *states)
+{
+    if (h->game_mode != GAME_MODE_TAIKO ||
+        h->hits_size != beatmap->hitobject_count)
+        return -OSUX_ERR_INVAL;
+
+    for (unsigned i = 0; i < h->hits_size; ++i) {
+        osux_hitobject const *ho = &beatmap->hitobjects[i];
+        if (!HIT_OBJECT_IS_CIRCLE(ho))
+            states[i] = OSUX_TAIKO_BONUS;
+        else if (h->hits[i].hit_type == HIT_300)
+            states[i] = OSUX_TAIKO_GREAT;
+        else if (h->hits[i].hit_type == HIT_MISS)
+            states[i] = OSUX_TAIKO_MISS;
+        else
+            states[i] = OSUX_TAIKO_GOOD;
+    }
     return 0;
 }
 
-static void compute_hit_stats(int hit_stats[], osux_hit *hits, size_t hits_size)
+static void compute_hit_stats(osux_hits *h)
 {
-    memset(hit_stats, 0, sizeof hit_stats[0] * MAX_HIT_TYPE);
+    memset(h->hit_stats, 0, sizeof h->hit_stats);
+    for (unsigned i = 0; i < h->hits_size; ++i)
+        ++ h->hit_stats[h->hits[i].hit_type];
+}
 
-    for (unsigned i = 0; i < hits_size; ++i)
-        ++ hit_stats[hits[i].hit_type];
+static void compute_timing_error(osux_hits *h)
+{
+    osux_error_stats stats;
+    osux_error_stats_init(&stats);
+    for (unsigned i = 0; i < h->hits_size; ++i) {
+        if (h->hits[i].timed)
+            osux_error_stats_add(&stats, h->hits[i].distance);
+    }
+    h->mean_error = stats.mean;
+    h->error_deviation = osux_error_stats_deviation(&stats);
+    h->unstable_rate = OSUX_UNSTABLE_RATE(h->error_deviation);
 }
 
-static void print_hit_stats(int hit_stats[])
+static void debug_hit_stats(osux_hits const *h, osux_beatmap const *beatmap)
 {
-    printf("300: %d\n", hit_stats[HIT_300]);
-    printf("100: %d\n", hit_stats[HIT_100]);
-    printf("50: %d\n", hit_stats[HIT_50]);
-    printf("MISS: %d\n", hit_stats[HIT_MISS]);
+    debug_hit_windows(h);
+    hits_debug(h, "OD: %g", beatmap->OverallDifficulty);
+    hits_debug(h, "max_distance: %ld", h->max_distance);
+    hits_debug(h, "300: %u", h->hit_stats[HIT_300]);
+    hits_debug(h, "100: %u", h->hit_stats[HIT_100]);
+    hits_debug(h, "50: %u", h->hit_stats[HIT_50]);
+    hits_debug(h, "MISS: %u", h->hit_stats[HIT_MISS]);
+    hits_debug(h, "mean error: %g, unstable rate: %g",
+               h->mean_error, h->unstable_rate);
 }
 
 int osux_hits_free(osux_hits *h)
@@ -439,41 +698,51 @@ int osux_hits_free(osux_hits *h)
 }
 
 typedef int (*compute_hit_fn)(osux_hits*, osux_beatmap const*);
-compute_hit_fn compute_mode[] = {
+static compute_hit_fn const compute_mode[] = {
     [GAME_MODE_STD] = osux_hits_compute_hits_std_basic,
-    [GAME_MODE_TAIKO] = osux_hits_compute_hits_taiko_basic,
+    [GAME_MODE_TAIKO] = osux_hits_compute_hits_taiko,
     [GAME_MODE_CTB] = NULL,
     [GAME_MODE_MANIA] = NULL,
 };
 
-int osux_hits_init(osux_hits *hits,
-                   osux_beatmap const *beatmap, osux_replay const *replay)
+int osux_hits_init_ex(osux_hits *hits,
+                      osux_beatmap const *beatmap, osux_replay const *replay,
+                      osux_hits_debug_fn debug, void *user_data)
 {
     memset(hits, 0, sizeof*hits);
     hits->game_mode = replay->game_mode;
     hits->overall_difficulty = beatmap->OverallDifficulty;
     hits->mods = replay->mods;
+    hits->debug = debug;
+    hits->debug_data = user_data;
 
     if (replay->game_mode >= MAX_GAME_MODE)
         return -OSUX_ERR_INVALID_GAME_MODE;
     if (replay->game_mode != beatmap->Mode)
         return -OSUX_ERR_AUTOCONVERT_NOT_SUPPORTED;
-
-    osux_hits_compute_data(hits, replay->data, replay->data_count);
-    osux_hits_compute_keypress(hits);
-    osux_hits_print_keypress(hits);
-
-    if (hits->keypress == NULL) {
-        osux_hits_free(hits);
-        return -1;
-    }
+    // the first two frames and the last one are not actual play
+    bool columns = replay->data == NULL;
+    if ((columns ? replay->frames.count : replay->data_count) < 3)
+        return -OSUX_ERR_REPLAY_DATA;
 
     compute_hit_fn compute = compute_mode[hits->game_mode];
-    if (compute == NULL) {
-        osux_hits_free(hits);
+    if (compute == NULL)
         return -OSUX_ERR_GAME_MODE_NOT_SUPPORTED;
+
+    if (columns) {
+        osux_hits_compute_keypress_frames(hits, &replay->frames);
+    } else {
+        osux_hits_compute_data(hits, replay->data, replay->data_count);
+        osux_hits_compute_keypress(hits);
     }
+    debug_keypress(hits);
 
+    if (hits->game_mode == GAME_MODE_TAIKO)
+        osux_get_taiko_hit_windows(hits->window, hits->overall_difficulty,
+                                   hits->mods);
+    else
+        osux_get_hit_windows(hits->window, hits->overall_difficulty,
+                             hits->mods);
     (*compute)(hits, beatmap);
 
     if (hits->hits == NULL) {
@@ -481,9 +750,37 @@ int osux_hits_init(osux_hits *hits,
         return -OSUX_ERR_UNKNOWN_ERROR;
     }
 
-    int hit_stats[MAX_HIT_TYPE];
-    compute_hit_stats(hit_stats, hits->hits, hits->hits_size);
-    print_hit_stats(hit_stats);
+    compute_hit_stats(hits);
+    compute_timing_error(hits);
+    debug_hit_stats(hits, beatmap);
+    return 0;
+}
+
+int osux_hits_init(osux_hits *hits,
+                   osux_beatmap const *beatmap, osux_replay const *replay)
+{
+    return osux_hits_init_ex(hits, beatmap, replay, NULL, NULL);
+}
+
+static void hits_job_run(gpointer data, gpointer user_data UNUSED)
+{
+    osux_hits_job *job = data;
+    job->err = osux_hits_init(&job->hits, job->beatmap, job->replay);
+}
+
+int osux_hits_compute_many(osux_hits_job *jobs, size_t count)
+{
+    if (count == 0)
+        return 0;
+
+    unsigned thread_count = MIN(g_get_num_processors(), count);
+    GThreadPool *pool = g_thread_pool_new(
+        &hits_job_run, NULL, thread_count, FALSE, NULL);
+    if (pool == NULL)
+        return -OSUX_ERR_UNKNOWN_ERROR;
 
+    for (size_t i = 0; i < count; ++i)
+        g_thread_pool_push(pool, &jobs[i], NULL);
+    g_thread_pool_free(pool, FALSE, TRUE); // waits for all the jobs
     return 0;
 }
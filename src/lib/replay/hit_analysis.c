@@ -0,0 +1,203 @@
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+
+#include "osux/hit_analysis.h"
+#include "osux/hitsound.h"
+#include "osux/keys.h"
+#include "osux/compiler.h"
+#include "osux/error.h"
+
+void osux_error_stats_init(osux_error_stats *stats)
+{
+    memset(stats, 0, sizeof *stats);
+}
+
+void osux_error_stats_add(osux_error_stats *stats, int64_t error)
+{
+    if (stats->count == 0) {
+        stats->min = error;
+        stats->max = error;
+    } else {
+        stats->min = MIN(stats->min, error);
+        stats->max = MAX(stats->max, error);
+    }
+    ++ stats->count;
+    double delta = error - stats->mean;
+    stats->mean += delta / stats->count;
+    stats->m2 += delta * (error - stats->mean);
+}
+
+double osux_error_stats_deviation(osux_error_stats const *stats)
+{
+    if (stats->count == 0)
+        return 0.;
+    return sqrt(stats->m2 / stats->count);
+}
+
+// key bits hit with the left hand
+static unsigned left_keys(int game_mode)
+{
+    if (game_mode == GAME_MODE_TAIKO)
+        return LEFT_DON | LEFT_KAT;
+    return KEY_LEFT; // mouse left and K1
+}
+
+// maps have a handful of bpms and *last, the previous one, is the likeliest
+static osux_error_stats *
+bpm_stats(osux_hit_analysis *a, double bpm, size_t *last)
+{
+    size_t i = *last;
+    if (i < a->bpm_count && a->bpms[i].bpm == bpm)
+        return &a->bpms[i].stats;
+
+    for (i = 0; i < a->bpm_count && a->bpms[i].bpm != bpm; ++i)
+        ;
+    if (i == a->bpm_count) {
+        a->bpms = g_renew(osux_bpm_stats, a->bpms, a->bpm_count + 1);
+        a->bpms[i].bpm = bpm;
+        osux_error_stats_init(&a->bpms[i].stats);
+        ++ a->bpm_count;
+    }
+    *last = i;
+    return &a->bpms[i].stats;
+}
+
+static int cmp_bpm(void const *a, void const *b)
+{
+    double x = ((osux_bpm_stats const*) a)->bpm;
+    double y = ((osux_bpm_stats const*) b)->bpm;
+    return (x > y) - (x < y);
+}
+
+static void add_hit(osux_hit_analysis *a, osux_hit const *hit,
+                    osux_hitobject const *ho, size_t *last_bpm)
+{
+    int64_t error = hit->distance;
+
+    osux_error_stats_add(&a->total, error);
+
+    size_t section = MAX(ho->offset, 0) / a->section_length;
+    osux_error_stats_add(&a->sections[section], error);
+
+    osux_error_stats_add(bpm_stats(a, ho->bpm, last_bpm), error);
+
+    if (hit->key != 0) {
+        unsigned bit = osux_ctz64(hit->key);
+        if (bit < OSUX_HIT_ANALYSIS_KEY_COUNT)
+            osux_error_stats_add(&a->keys[bit], error);
+        if (hit->key & left_keys(a->game_mode))
+            osux_error_stats_add(&a->left, error);
+        else
+            osux_error_stats_add(&a->right, error);
+    }
+
+    if (a->game_mode == GAME_MODE_TAIKO) {
+        if (ho->hitsound.sample & SAMPLE_TAIKO_KAT)
+            osux_error_stats_add(&a->kat, error);
+        else
+            osux_error_stats_add(&a->don, error);
+    }
+}
+
+int osux_hit_analysis_init(osux_hit_analysis *analysis,
+                           osux_hits const *hits, osux_beatmap const *beatmap,
+                           int64_t section_length)
+{
+    memset(analysis, 0, sizeof *analysis);
+    if (hits->hits_size != beatmap->hitobject_count)
+        return -OSUX_ERR_INVAL;
+
+    analysis->game_mode = hits->game_mode;
+    analysis->section_length = section_length > 0 ?
+        section_length : OSUX_HIT_ANALYSIS_SECTION_LENGTH;
+
+    int64_t last_offset = 0;
+    for (unsigned i = 0; i < beatmap->hitobject_count; ++i)
+        last_offset = MAX(last_offset, beatmap->hitobjects[i].offset);
+    analysis->section_count = MAX(last_offset, 0) / analysis->section_length + 1;
+    analysis->sections = g_new0(osux_error_stats, analysis->section_count);
+
+    size_t last_bpm = 0;
+    for (unsigned i = 0; i < hits->hits_size; ++i) {
+        if (hits->hits[i].timed)
+            add_hit(analysis, &hits->hits[i], &beatmap->hitobjects[i],
+                    &last_bpm);
+    }
+    qsort(analysis->bpms, analysis->bpm_count, sizeof analysis->bpms[0],
+          &cmp_bpm);
+
+    analysis->unstable_rate =
+        OSUX_UNSTABLE_RATE(osux_error_stats_deviation(&analysis->total));
+    return 0;
+}
+
+void osux_hit_analysis_free(osux_hit_analysis *analysis)
+{
+    g_free(analysis->sections);
+    g_free(analysis->bpms);
+    memset(analysis, 0, sizeof *analysis);
+}
+
+static void print_stats(FILE *f, char const *name, osux_error_stats const *s)
+{
+    double deviation = osux_error_stats_deviation(s);
+    fprintf(f, "%s: hits=%lu mean=%.2f deviation=%.2f ur=%.2f"
+            " min=%ld max=%ld\n", name, s->count, s->mean, deviation,
+            OSUX_UNSTABLE_RATE(deviation), s->min, s->max);
+}
+
+void osux_hit_analysis_print(osux_hit_analysis const *a, FILE *f)
+{
+    // a K1 (K2) press also sets the M1 (M2) bit, and is counted there
+    static char const *std_keys[] = { "K1/M1", "K2/M2", "K1", "K2" };
+    static char const *taiko_keys[] = {
+        "left don", "left kat", "right don", "right kat"
+    };
+    char const **key_names = a->game_mode == GAME_MODE_TAIKO ?
+        taiko_keys : std_keys;
+
+    fprintf(f, "unstable rate: %.2f\n", a->unstable_rate);
+    print_stats(f, "all", &a->total);
+
+    for (size_t i = 0; i < a->section_count; ++i) {
+        if (a->sections[i].count == 0)
+            continue;
+        char *name = g_strdup_printf(
+            "section %ld-%ld", i * a->section_length,
+            (i + 1) * a->section_length);
+        print_stats(f, name, &a->sections[i]);
+        g_free(name);
+    }
+    for (size_t i = 0; i < a->bpm_count; ++i) {
+        char *name = g_strdup_printf("bpm %g", a->bpms[i].bpm);
+        print_stats(f, name, &a->bpms[i].stats);
+        g_free(name);
+    }
+    for (unsigned i = 0; i < OSUX_HIT_ANALYSIS_KEY_COUNT; ++i) {
+        if (a->keys[i].count > 0)
+            print_stats(f, key_names[i], &a->keys[i]);
+    }
+    print_stats(f, "left", &a->left);
+    print_stats(f, "right", &a->right);
+    if (a->game_mode == GAME_MODE_TAIKO) {
+        print_stats(f, "don", &a->don);
+        print_stats(f, "kat", &a->kat);
+    }
+}
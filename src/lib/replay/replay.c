@@ -20,7 +20,6 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <time.h>
-#include <locale.h>
 
 #include "osux/game_mode.h"
 #include "osux/util.h"
@@ -30,53 +29,133 @@
 #include "osux/buffer_reader.h"
 #include "osux/keys.h"
 #include "osux/error.h"
+#include "osux/xz_decomp.h"
+#include "../beatmap/field_cursor.h"
 
 #define read_string(buf_ptr_, file_) read_string_ULEB128(buf_ptr_, file_)
 
-static int replay_data_init(osux_replay_data *d, char *datastr)
-{
-    gchar **split = g_strsplit(datastr, "|", 0);
-    unsigned size = strsplit_size(split);
+// longest frame accepted across the boundary of two decompressed chunks
+#define MAX_FRAME_LENGTH 128
+#define INITIAL_FRAME_CAPACITY 1024
 
-    if (size != 4) {
-        g_strfreev(split);
+/*
+ * Frames are "w|x|y|z" separated by commas; they are parsed from the
+ * decompressed chunks as they come, without ever holding the whole text.
+ */
+typedef struct frame_parser_ {
+    osux_replay *r;
+    bool columns; // OSUX_REPLAY_FRAME_COLUMNS
+    uint64_t capacity;
+    char partial[MAX_FRAME_LENGTH + 1]; // frame cut by the end of a chunk
+    size_t partial_length;
+} frame_parser;
+
+static int parse_frame(frame_parser *p, char const *begin, char const *end)
+{
+    osux_field frame = { begin, end }, fields[4];
+    osux_field_cursor c;
+    unsigned count = 0;
+
+    osux_field_cursor_init(&c, &frame);
+    while (count < 4 && osux_field_next(&c, '|', &fields[count]))
+        ++ count;
+    if (count != 4 || !c.done)
         return -OSUX_ERR_REPLAY_DATA;
+
+    osux_replay *r = p->r;
+    int64_t previous_time = osux_field_to_int64(&fields[0]);
+    int64_t keys = osux_field_to_int64(&fields[3]);
+    if (previous_time == OSUX_REPLAY_SEED_FRAME_TIME) {
+        r->rng_seed = (uint32_t) keys;
+        keys = 0;
     }
 
-    d->previous_time = g_ascii_strtoull(split[0], NULL, 10);
-    d->x = g_ascii_strtod(split[1], NULL);
-    d->y = g_ascii_strtod(split[2], NULL);
-    d->keys = atoi(split[3]);
+    if (p->columns) {
+        return osux_replay_frames_append(
+            &r->frames, previous_time,
+            osux_field_to_double(&fields[1]), osux_field_to_double(&fields[2]),
+            keys);
+    }
+    if (r->data_count == p->capacity) {
+        p->capacity = p->capacity ? 2 * p->capacity : INITIAL_FRAME_CAPACITY;
+        r->data = g_renew(osux_replay_data, r->data, p->capacity);
+    }
+    osux_replay_data *d = &r->data[r->data_count];
+    d->previous_time = previous_time;
+    d->x = osux_field_to_double(&fields[1]);
+    d->y = osux_field_to_double(&fields[2]);
+    d->keys = keys;
     d->time_offset = 0;
+    if (r->data_count > 0)
+        d->time_offset = (d-1)->time_offset + d->previous_time;
+    ++ r->data_count;
+    return 0;
+}
 
-    g_strfreev(split);
+static int append_partial(frame_parser *p, char const *begin, char const *end)
+{
+    size_t length = end - begin;
+    if (p->partial_length + length > MAX_FRAME_LENGTH)
+        return -OSUX_ERR_REPLAY_DATA;
+    memcpy(p->partial + p->partial_length, begin, length);
+    p->partial_length += length;
+    p->partial[p->partial_length] = 0;
     return 0;
 }
 
-static int parse_replay_data(osux_replay *r, char const *data)
+static int parse_frame_chunk(uint8_t const *chunk, size_t size, void *user_data)
 {
-    int err = 0;
-    if (data == NULL)
+    frame_parser *p = user_data;
+    char const *pos = (char const*) chunk, *end = pos + size;
+    char const *comma;
+    int err;
+
+    if (p->partial_length > 0) {
+        comma = memchr(pos, ',', end - pos);
+        if ((err = append_partial(p, pos, comma ? comma : end)) < 0)
+            return err;
+        if (comma == NULL)
+            return 0;
+        err = parse_frame(p, p->partial, p->partial + p->partial_length);
+        if (err < 0)
+            return err;
+        p->partial_length = 0;
+        pos = comma + 1;
+    }
+    while ((comma = memchr(pos, ',', end - pos)) != NULL) {
+        if ((err = parse_frame(p, pos, comma)) < 0)
+            return err;
+        pos = comma + 1;
+    }
+    return append_partial(p, pos, end);
+}
+
+static int parse_replay_data(osux_replay *r, osux_buffer_reader *br, int flags)
+{
+    if (r->replay_length == 0)
         return 0; // not an error: replay with no data can exist
 
-    char **data_split = g_strsplit(data, ",", 0);
-    unsigned size = strsplit_size(data_split);
+    osux_buffer_view stream;
+    int err = osux_buffer_reader_read_view(br, r->replay_length, &stream);
+    if (err < 0)
+        return err;
 
-    ALLOC_ARRAY(r->data, r->data_count, size);
-    for (unsigned i = 0; i < size; ++i) {
-        if (i == size-1 && !strcmp(data_split[i], "")) {
-            // see parse_life_graph()
-            -- r->data_count;
-            break;
-        }
-        if ((err = replay_data_init(&r->data[i], data_split[i])) < 0)
-            break;
-        osux_replay_data *d = &r->data[i];
-        if (i > 0)
-            d->time_offset = (d-1)->time_offset + d->previous_time;
-    }
-    g_strfreev(data_split);
-    return err;
+    frame_parser p;
+    memset(&p, 0, sizeof p);
+    p.r = r;
+    p.columns = (flags & OSUX_REPLAY_FRAME_COLUMNS) != 0;
+    err = osux_lzma_decoder_decode_chunks(
+        osux_lzma_thread_decoder(), (uint8_t const*) stream.ptr, stream.len,
+        &parse_frame_chunk, &p);
+    // the last frame usually has a trailing comma, see parse_life_graph()
+    if (!err && p.partial_length > 0)
+        err = parse_frame(&p, p.partial, p.partial + p.partial_length);
+    if (err < 0)
+        return err;
+
+    r->data = g_renew(osux_replay_data, r->data, r->data_count);
+    osux_replay_frames_shrink(&r->frames);
+    return 0;
 }
 
 #define TICKS_PER_SECONDS 10000000L
@@ -89,15 +168,10 @@ static time_t from_win_timestamp(uint64_t ticks)
     return (ticks - TICKS_AT_EPOCH) / TICKS_PER_SECONDS;
 }
 
+// the date is formatted with the current locale;
+// the program is responsible for calling setlocale()
 static void print_date(FILE *f, time_t t)
 {
-    static gboolean locale_is_set = FALSE;
-
-    if (!locale_is_set) {
-        setlocale(LC_ALL, ""); // TODO: move this
-        locale_is_set = TRUE;
-    }
-
     GDateTime *dateTime = g_date_time_new_from_unix_local(t);
     g_assert(dateTime != NULL);
 
@@ -107,110 +181,136 @@ static void print_date(FILE *f, time_t t)
     g_date_time_unref(dateTime);
 }
 
-static int replay_life_init(osux_replay_life *life, char const *lifestr)
+// "time|life"
+static int replay_life_init(osux_replay_life *life, osux_field const *point)
 {
-    gchar **split = g_strsplit(lifestr, "|", 0);
-    unsigned size = strsplit_size(split);
-    if (size != 2) {
-        g_strfreev(split);
+    osux_field fields[2];
+    osux_field_cursor c;
+    unsigned count = 0;
+
+    osux_field_cursor_init(&c, point);
+    while (count < 2 && osux_field_next(&c, '|', &fields[count]))
+        ++ count;
+    if (count != 2 || !c.done)
         return -OSUX_ERR_REPLAY_LIFE_BAR;
-    }
-
-    life->time_offset = g_ascii_strtoull(split[0], NULL, 10);
-    life->life_amount = g_ascii_strtod(split[1], NULL);
 
-    g_strfreev(split);
+    life->time_offset = osux_field_to_int64(&fields[0]);
+    life->life_amount = osux_field_to_double(&fields[1]);
     return 0;
 }
 
-static int parse_life_graph(osux_replay *r, char const *life_graph)
+// parsed in place, from the replay file data
+static int parse_life_graph(osux_replay *r, osux_buffer_view const *life_graph)
 {
     int err = 0;
 
-    if (life_graph == NULL) {
+    if (life_graph->ptr == NULL) {
         // not an error:
         // 'pure score' .osr file have no data and no life graph
         return 0;
     }
 
-    char **life_split = g_strsplit(life_graph, ",", 0);
-    unsigned size = strsplit_size(life_split);
+    osux_field graph = { life_graph->ptr, life_graph->ptr + life_graph->len };
+    osux_field point;
+    osux_field_cursor c;
+    unsigned size = osux_field_count(&graph, ',');
 
     ALLOC_ARRAY(r->life, r->life_count, size);
-    for (unsigned i = 0; i < size; ++i) {
-        if (i == size-1 && !strcmp(life_split[i], "")) {
+    osux_field_cursor_init(&c, &graph);
+    for (unsigned i = 0; osux_field_next(&c, ',', &point); ++i) {
+        if (i == size-1 && point.begin == point.end) {
             // this often happens: a comma get appended in the end
-            // but glib will still report a empty token
             -- r->life_count;
             break;
         }
-        if ((err = replay_life_init(&r->life[i], life_split[i])) < 0)
+        if ((err = replay_life_init(&r->life[i], &point)) < 0)
             break;
     }
-    g_strfreev(life_split);
     return err;
 }
 
-#define READ_S(handle_, var_) \
-    osux_buffer_reader_read_string(&(handle_), &(var_))
-#define READ_V(handle_, var_) \
-    osux_buffer_reader_read(&(handle_), &(var_), sizeof (var_))
+#define CHK(expr)                               \
+    do {                                        \
+        int err_macro_;                         \
+        if ((err_macro_ = (expr)) < 0)          \
+            return err_macro_;                  \
+    } while (0)
 
-int osux_replay_init(osux_replay *r, char const *filepath)
+#define READ_S(handle_, var_) \
+    CHK(osux_buffer_reader_read_string((handle_), &(var_)))
+#define READ_U8(handle_, var_) \
+    CHK(osux_buffer_reader_read_u8((handle_), &(var_)))
+#define READ_U16(handle_, var_) \
+    CHK(osux_buffer_reader_read_u16((handle_), &(var_)))
+#define READ_U32(handle_, var_) \
+    CHK(osux_buffer_reader_read_u32((handle_), &(var_)))
+#define READ_U64(handle_, var_) \
+    CHK(osux_buffer_reader_read_u64((handle_), &(var_)))
+
+static int read_replay(osux_replay *r, osux_buffer_reader *br, int flags)
 {
-    int err = 0;
-    gsize length;  gchar *contents;
-    if (!g_file_get_contents(filepath, &contents, &length, NULL))
-        return -OSUX_ERR_FILE_ERROR;
-
-    osux_buffer_reader br;
-    osux_buffer_reader_init(&br, contents, length);
-
-    memset(r, 0, sizeof *r);
-
-    READ_V(br, r->game_mode);
-    READ_V(br, r->game_version);
+    READ_U8(br, r->game_mode);
+    READ_U32(br, r->game_version);
 
     READ_S(br, r->beatmap_hash);
     READ_S(br, r->player_name);
     READ_S(br, r->replay_hash);
 
-    READ_V(br, r->_300);
-    READ_V(br, r->_100);
-    READ_V(br, r->_50);
-    READ_V(br, r->_geki);
-    READ_V(br, r->_katu);
-    READ_V(br, r->_miss);
-
-    READ_V(br, r->score);
-    READ_V(br, r->max_combo);
-    READ_V(br, r->fc);
-    READ_V(br, r->mods);
-
-    char *life_graph = NULL;
-    READ_S(br, life_graph);
-    if ((err = parse_life_graph(r, life_graph)) < 0) {
-        osux_replay_free(r);
-        osux_buffer_reader_free(&br);
-        return err;
-    }
-    g_free(life_graph);
+    READ_U16(br, r->_300);
+    READ_U16(br, r->_100);
+    READ_U16(br, r->_50);
+    READ_U16(br, r->_geki);
+    READ_U16(br, r->_katu);
+    READ_U16(br, r->_miss);
+
+    READ_U32(br, r->score);
+    READ_U16(br, r->max_combo);
+    READ_U8(br, r->fc);
+    READ_U32(br, r->mods);
+
+    osux_buffer_view life_graph;
+    CHK( osux_buffer_reader_read_string_view(br, &life_graph) );
+    if (!(flags & OSUX_REPLAY_SKIP_LIFE_GRAPH))
+        CHK( parse_life_graph(r, &life_graph) );
 
     uint64_t ticks;
-    READ_V(br, ticks);
+    READ_U64(br, ticks);
     r->timestamp = from_win_timestamp(ticks);
 
-    READ_V(br, r->replay_length);
-    char *data = NULL;
-    osux_buffer_reader_read_lzma(&br, &data, r->replay_length);
-    if ((err = parse_replay_data(r, data)) < 0) {
-        osux_replay_free(r);
-        osux_buffer_reader_free(&br);
-        return err;
-    }
-    g_free(data);
+    READ_U32(br, r->replay_length);
+    if (flags & OSUX_REPLAY_SKIP_FRAMES)
+        return 0;
+    return parse_replay_data(r, br, flags);
+}
+
+/*
+ * The file is mapped rather than read: the header is parsed in place and
+ * only the pages actually used are loaded, which is just the first one
+ * with OSUX_REPLAY_SKIP_FRAMES.
+ */
+int osux_replay_init_ex(osux_replay *r, char const *filepath, int flags)
+{
+    memset(r, 0, sizeof *r);
+
+    GMappedFile *file = g_mapped_file_new(filepath, FALSE, NULL);
+    if (file == NULL)
+        return -OSUX_ERR_FILE_ACCESS;
+
+    osux_buffer_reader br;
+    osux_buffer_reader_init(&br, g_mapped_file_get_contents(file),
+                            g_mapped_file_get_length(file));
+    int err = read_replay(r, &br, flags);
     osux_buffer_reader_free(&br);
-    return 0;
+    g_mapped_file_unref(file);
+
+    if (err < 0)
+        osux_replay_free(r);
+    return err;
+}
+
+int osux_replay_init(osux_replay *r, char const *filepath)
+{
+    return osux_replay_init_ex(r, filepath, 0);
 }
 
 void osux_replay_print(osux_replay const *r, FILE *f)
@@ -260,6 +360,7 @@ void osux_replay_free(osux_replay *r)
     g_free(r->replay_hash);
     g_free(r->life);
     g_free(r->data);
+    osux_replay_frames_free(&r->frames);
     memset(r, 0, sizeof *r);
 }
 
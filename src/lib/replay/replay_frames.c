@@ -0,0 +1,124 @@
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include <glib.h>
+
+#include "osux/replay_frames.h"
+#include "osux/error.h"
+
+#define INITIAL_CAPACITY 1024
+
+void osux_replay_frames_init(osux_replay_frames *frames)
+{
+    memset(frames, 0, sizeof *frames);
+}
+
+void osux_replay_frames_free(osux_replay_frames *frames)
+{
+    g_free(frames->delta);
+    g_free(frames->x);
+    g_free(frames->y);
+    g_free(frames->keys);
+    g_free(frames->checkpoints);
+    memset(frames, 0, sizeof *frames);
+}
+
+static uint64_t checkpoint_count(uint64_t frame_count)
+{
+    return (frame_count + OSUX_REPLAY_FRAMES_CHECKPOINT - 1)
+        / OSUX_REPLAY_FRAMES_CHECKPOINT;
+}
+
+static void resize(osux_replay_frames *frames, uint64_t capacity)
+{
+    frames->delta = g_renew(int32_t, frames->delta, capacity);
+    frames->x = g_renew(float, frames->x, capacity);
+    frames->y = g_renew(float, frames->y, capacity);
+    frames->keys = g_renew(uint16_t, frames->keys, capacity);
+    frames->checkpoints = g_renew(int64_t, frames->checkpoints,
+                                  checkpoint_count(capacity));
+    frames->capacity = capacity;
+}
+
+int osux_replay_frames_append(osux_replay_frames *frames, int64_t previous_time,
+                              double x, double y, uint32_t keys)
+{
+    if (previous_time < INT32_MIN || previous_time > INT32_MAX ||
+        keys > UINT16_MAX)
+        return -OSUX_ERR_REPLAY_DATA;
+
+    uint64_t i = frames->count;
+    if (i == frames->capacity)
+        resize(frames, i ? 2 * i : INITIAL_CAPACITY);
+
+    frames->delta[i] = (int32_t) previous_time;
+    frames->x[i] = (float) x;
+    frames->y[i] = (float) y;
+    frames->keys[i] = (uint16_t) keys;
+    if (i % OSUX_REPLAY_FRAMES_CHECKPOINT == 0) {
+        frames->checkpoints[i / OSUX_REPLAY_FRAMES_CHECKPOINT] = i == 0 ? 0 :
+            osux_replay_frames_time_at(frames, i - 1) + previous_time;
+    }
+    ++ frames->count;
+    return 0;
+}
+
+void osux_replay_frames_shrink(osux_replay_frames *frames)
+{
+    if (frames->count == 0) {
+        osux_replay_frames_free(frames);
+        return;
+    }
+    resize(frames, frames->count);
+}
+
+void osux_replay_frames_times(osux_replay_frames const *frames,
+                              uint64_t first, uint64_t count, int64_t *times)
+{
+    if (count == 0)
+        return;
+    int64_t time = osux_replay_frames_time_at(frames, first);
+    times[0] = time;
+    for (uint64_t k = 1; k < count; ++k) {
+        time += frames->delta[first + k];
+        times[k] = time;
+    }
+}
+
+uint64_t osux_replay_frames_find(osux_replay_frames const *frames, int64_t time)
+{
+    if (frames->count == 0)
+        return 0;
+
+    // last checkpoint at or before 'time'
+    uint64_t low = 0, high = checkpoint_count(frames->count);
+    while (high - low > 1) {
+        uint64_t mid = low + (high - low) / 2;
+        if (frames->checkpoints[mid] <= time)
+            low = mid;
+        else
+            high = mid;
+    }
+
+    uint64_t i = low * OSUX_REPLAY_FRAMES_CHECKPOINT;
+    int64_t t = frames->checkpoints[low];
+    while (i + 1 < frames->count && t + frames->delta[i + 1] <= time) {
+        t += frames->delta[i + 1];
+        ++ i;
+    }
+    return i;
+}
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "osux/replay.h"
+#include "osux/error.h"
+
+// header reads are small and mostly wait on the disk: more threads than cores
+#define THREADS_PER_PROCESSOR 2
+// maximum number of loaded replays waiting for delivery, per thread
+#define IN_FLIGHT_PER_THREAD 4
+
+typedef struct scan_job_ {
+    char *path;
+    int flags;
+    int err;
+    osux_replay replay;
+} scan_job;
+
+static void scan_job_run(gpointer data, gpointer user_data)
+{
+    scan_job *job = data;
+    GAsyncQueue *done = user_data;
+
+    job->err = osux_replay_init_ex(&job->replay, job->path, job->flags);
+    g_async_queue_push(done, job);
+}
+
+static void scan_job_deliver(scan_job *job, osux_replay_scan_fn callback,
+                             void *user_data)
+{
+    if (job->err < 0) {
+        (*callback)(NULL, job->path, job->err, user_data);
+    } else {
+        (*callback)(&job->replay, job->path, job->err, user_data);
+        osux_replay_free(&job->replay);
+    }
+    g_free(job->path);
+    g_free(job);
+}
+
+static bool is_replay_file(char const *name)
+{
+    size_t length = strlen(name);
+    return length > 4 && !g_ascii_strcasecmp(name + length - 4, ".osr");
+}
+
+static GPtrArray *list_replays(char const *dir_path)
+{
+    GDir *dir = g_dir_open(dir_path, 0, NULL);
+    if (dir == NULL)
+        return NULL;
+
+    GPtrArray *paths = g_ptr_array_new();
+    char const *name;
+    while ((name = g_dir_read_name(dir)) != NULL) {
+        if (is_replay_file(name))
+            g_ptr_array_add(paths, g_build_filename(dir_path, name, NULL));
+    }
+    g_dir_close(dir);
+    return paths;
+}
+
+int osux_replay_scan(char const *dir_path, int flags,
+                     osux_replay_scan_fn callback, void *user_data)
+{
+    if (dir_path == NULL || callback == NULL)
+        return -OSUX_ERR_INVAL;
+
+    GPtrArray *paths = list_replays(dir_path);
+    if (paths == NULL)
+        return -OSUX_ERR_FILE_ACCESS;
+    if (paths->len == 0) {
+        g_ptr_array_free(paths, TRUE);
+        return 0;
+    }
+
+    unsigned thread_count = g_get_num_processors() * THREADS_PER_PROCESSOR;
+    unsigned max_in_flight = thread_count * IN_FLIGHT_PER_THREAD;
+
+    GAsyncQueue *done = g_async_queue_new();
+    GThreadPool *pool = g_thread_pool_new(
+        &scan_job_run, done, thread_count, FALSE, NULL);
+    if (pool == NULL) {
+        g_async_queue_unref(done);
+        g_ptr_array_free(paths, TRUE);
+        return -OSUX_ERR_UNKNOWN_ERROR;
+    }
+
+    unsigned submitted = 0, delivered = 0, in_flight = 0;
+    while (delivered < paths->len) {
+        while (submitted < paths->len && in_flight < max_in_flight) {
+            scan_job *job = g_new0(scan_job, 1);
+            job->path = paths->pdata[submitted]; // owned by the job now
+            job->flags = flags;
+            g_thread_pool_push(pool, job, NULL);
+            ++ submitted;
+            ++ in_flight;
+        }
+        scan_job_deliver(g_async_queue_pop(done), callback, user_data);
+        ++ delivered;
+        -- in_flight;
+    }
+
+    g_thread_pool_free(pool, FALSE, TRUE);
+    g_async_queue_unref(done);
+    g_ptr_array_free(paths, TRUE); // the paths were freed with the jobs
+    return 0;
+}
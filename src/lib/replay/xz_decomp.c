@@ -1,38 +1,43 @@
 /*
- * xz_decomp.c
- * A simple example of pipe-only xz decompressor implementation.
- * version: 2010-07-12 - by Daniel Mealha Cabrita
- * Not copyrighted -- provided to the public domain.
+ *  Copyright (©) 2015 Lucas Maugère, Thomas Mijieux
  *
- * Compiling:
- * Link with liblzma. GCC example:
- * $ gcc -llzma xz_pipe_decomp.c -o xz_pipe_decomp
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
  *
- * Usage example:
- * $ cat some_file.xz | ./xz_pipe_decomp > some_file
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
  */
 
 #include <stdlib.h>
 #include <inttypes.h>
 #include <stdbool.h>
 #include <lzma.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <gio/gio.h>
+#include <glib.h>
 
 #include "osux/xz_decomp.h"
-
-/* read/write buffer sizes */
-#define IN_BUF_MAX	512
-#define OUT_BUF_MAX	512
-
-/* error codes */
-#define RET_OK			0
-#define RET_ERROR_INIT		1
-#define RET_ERROR_INPUT		2
-#define RET_ERROR_OUTPUT	3
-#define RET_ERROR_DECOMPRESSION	4
-
+#include "osux/error.h"
+
+// .lzma header: properties (1 byte), dictionary size (4), uncompressed size (8)
+#define LZMA_ALONE_HEADER_SIZE 13
+#define LZMA_ALONE_SIZE_OFFSET 5
+// sizes announced by the header above this are not trusted for allocation
+#define MAX_ANNOUNCED_SIZE (256 << 20)
+// output buffer size relative to the input when the size is unknown
+#define UNKNOWN_SIZE_RATIO 4
+#define MIN_OUTPUT_SIZE 4096
+// output window of decode_chunks
+#define CHUNK_SIZE (64 << 10)
+
+struct osux_lzma_decoder_ {
+    lzma_stream stream;
+    uint8_t *chunk; // allocated on first use
+};
 
 static void lzma_error(lzma_ret error_code)
 {
@@ -52,98 +57,150 @@ static void lzma_error(lzma_ret error_code)
     }
 }
 
-/* note: in_file and out_file must be open already */
-static int lzma_legacy_decompress(GInputStream *in_file, GOutputStream *out_file)
+osux_lzma_decoder *osux_lzma_decoder_new(void)
 {
-    lzma_stream strm = LZMA_STREAM_INIT; /* alloc and init lzma_stream struct */
-    const uint64_t memory_limit = UINT64_MAX; /* no memory limit */
-    uint8_t in_buf [IN_BUF_MAX];
-    uint8_t out_buf [OUT_BUF_MAX];
-    ssize_t in_len;	/* length of useful data in in_buf */
-    ssize_t out_len;	/* length of useful data in out_buf */
-    bool in_finished = false;
-    bool out_finished = false;
-    lzma_action action;
-    lzma_ret ret_xz;
-    int ret;
-
-    ret = RET_OK;
-
-    /* initialize lzma decoder */
-    ret_xz = lzma_alone_decoder(&strm, memory_limit);
-    if (ret_xz != LZMA_OK) {
-	fprintf (stderr, "lzma_stream_decoder error: %d\n", (int) ret_xz);
-	return RET_ERROR_INIT;
+    osux_lzma_decoder *dec = g_new(osux_lzma_decoder, 1);
+    lzma_stream init = LZMA_STREAM_INIT;
+    dec->stream = init;
+    dec->chunk = NULL;
+    return dec;
+}
+
+void osux_lzma_decoder_free(osux_lzma_decoder *dec)
+{
+    if (dec == NULL)
+        return;
+    lzma_end(&dec->stream);
+    g_free(dec->chunk);
+    g_free(dec);
+}
+
+// uncompressed size from the header, 0 when unknown
+static size_t announced_size(uint8_t const *in, size_t in_size)
+{
+    if (in_size < LZMA_ALONE_HEADER_SIZE)
+        return 0;
+    uint64_t size = 0;
+    for (unsigned i = 8; i-- > 0; )
+        size = (size << 8) | in[LZMA_ALONE_SIZE_OFFSET + i];
+    if (size == UINT64_MAX || size > MAX_ANNOUNCED_SIZE)
+        return 0;
+    return size;
+}
+
+static void reserve(uint8_t **buf, size_t *buf_size, size_t size)
+{
+    if (*buf_size >= size)
+        return;
+    *buf = g_realloc(*buf, size);
+    *buf_size = size;
+}
+
+static int decoder_start(osux_lzma_decoder *dec,
+                         uint8_t const *in, size_t in_size)
+{
+    // re-initializing the same decoder reuses its allocations
+    lzma_ret ret = lzma_alone_decoder(&dec->stream, UINT64_MAX);
+    if (ret != LZMA_OK) {
+        fprintf(stderr, "lzma_alone_decoder error: %d\n", (int) ret);
+        return -OSUX_ERR_UNKNOWN_ERROR;
     }
+    dec->stream.next_in = in;
+    dec->stream.avail_in = in_size;
+    return 0;
+}
 
-    while ((!in_finished) && (!out_finished)) {
-	/* read incoming data */
-	in_len = g_input_stream_read(in_file, in_buf, IN_BUF_MAX, NULL, NULL);
-
-	if (in_len == 0)
-	    in_finished = true; //end of file
-
-	if (in_len < 0) {
-	    in_finished = true;
-	    ret = RET_ERROR_INPUT;
-            in_len = 0;
-        }
-
-	strm.next_in = in_buf;
-	strm.avail_in = in_len;
-
-	/* if no more data from in_buf, flushes the
-	   internal xz buffers and closes the decompressed data
-	   with LZMA_FINISH */
-	action = in_finished ? LZMA_FINISH : LZMA_RUN;
-
-	/* loop until there's no pending decompressed output */
-	do {
-	    /* out_buf is clean at this point */
-	    strm.next_out = out_buf;
-	    strm.avail_out = OUT_BUF_MAX;
-
-	    /* decompress data */
-	    ret_xz = lzma_code(&strm, action);
-
-	    if ((ret_xz != LZMA_OK) && (ret_xz != LZMA_STREAM_END)) {
-                lzma_error(ret_xz);
-		out_finished = true;
-		ret = RET_ERROR_DECOMPRESSION;
-	    } else {
-		/* write decompressed data */
-		out_len = OUT_BUF_MAX - strm.avail_out;
-                ssize_t err;
-		err = g_output_stream_write(out_file, out_buf, out_len, NULL, NULL);
-		if (err < 0) {
-		    out_finished = true;
-		    ret = RET_ERROR_OUTPUT;
-		}
-	    }
-	} while (strm.avail_out == 0);
+int osux_lzma_decoder_decode(osux_lzma_decoder *dec,
+                             uint8_t const *in, size_t in_size,
+                             uint8_t **buf, size_t *buf_size, size_t *out_len)
+{
+    lzma_stream *strm = &dec->stream;
+    lzma_ret ret;
+    int err;
+    if ((err = decoder_start(dec, in, in_size)) < 0)
+        return err;
+
+    size_t size = announced_size(in, in_size);
+    if (size == 0)
+        size = MAX(in_size * UNKNOWN_SIZE_RATIO, MIN_OUTPUT_SIZE);
+    reserve(buf, buf_size, size + 1); // + the terminating null byte
+
+    size_t len = 0;
+    do {
+        if (len + 1 == *buf_size)
+            reserve(buf, buf_size, *buf_size * 2);
+        strm->next_out = *buf + len;
+        strm->avail_out = *buf_size - 1 - len;
+        ret = lzma_code(strm, LZMA_FINISH);
+        len = strm->next_out - *buf;
+    } while (ret == LZMA_OK);
+
+    if (ret != LZMA_STREAM_END) {
+        lzma_error(ret);
+        *out_len = 0;
+        return -OSUX_ERR_REPLAY_DATA;
     }
+    (*buf)[len] = 0;
+    *out_len = len;
+    return 0;
+}
 
-    lzma_end (&strm);
-    return ret;
+int osux_lzma_decoder_decode_chunks(osux_lzma_decoder *dec,
+                                    uint8_t const *in, size_t in_size,
+                                    osux_lzma_chunk_fn callback,
+                                    void *user_data)
+{
+    lzma_stream *strm = &dec->stream;
+    lzma_ret ret;
+    int err;
+    if ((err = decoder_start(dec, in, in_size)) < 0)
+        return err;
+    if (dec->chunk == NULL)
+        dec->chunk = g_malloc(CHUNK_SIZE);
+
+    do {
+        strm->next_out = dec->chunk;
+        strm->avail_out = CHUNK_SIZE;
+        ret = lzma_code(strm, LZMA_FINISH);
+        size_t len = strm->next_out - dec->chunk;
+        if (len > 0 && (err = (*callback)(dec->chunk, len, user_data)) < 0)
+            return err;
+    } while (ret == LZMA_OK);
+
+    if (ret != LZMA_STREAM_END) {
+        lzma_error(ret);
+        return -OSUX_ERR_REPLAY_DATA;
+    }
+    return 0;
 }
 
-void lzma_decompress(uint8_t *in_buf, size_t in_size,
-                     uint8_t **out_buf, size_t *out_len)
+static void thread_decoder_free(gpointer dec)
 {
-    GInputStream *is;
-    GOutputStream *os;
+    osux_lzma_decoder_free(dec);
+}
 
-    is = g_memory_input_stream_new_from_data(in_buf, in_size, NULL);
-    os = g_memory_output_stream_new(NULL, 0, g_realloc, NULL);
+static GPrivate thread_decoder = G_PRIVATE_INIT(&thread_decoder_free);
 
-    if (lzma_legacy_decompress(is, os) != 0) {
-        *out_len = 0;
-        *out_buf = NULL;
-    } else {
-        *out_buf = g_memory_output_stream_get_data((GMemoryOutputStream*) os);
-        *out_len = g_memory_output_stream_get_size((GMemoryOutputStream*) os);
+osux_lzma_decoder *osux_lzma_thread_decoder(void)
+{
+    osux_lzma_decoder *dec = g_private_get(&thread_decoder);
+    if (dec == NULL) {
+        dec = osux_lzma_decoder_new();
+        g_private_set(&thread_decoder, dec);
     }
+    return dec;
+}
+
+void lzma_decompress(uint8_t const *in_buf, size_t in_size,
+                     uint8_t **out_buf, size_t *out_len)
+{
+    osux_lzma_decoder *dec = osux_lzma_thread_decoder();
 
-    g_object_unref(is);
-    g_object_unref(os);
+    size_t buf_size = 0;
+    *out_buf = NULL;
+    if (osux_lzma_decoder_decode(dec, in_buf, in_size,
+                                 out_buf, &buf_size, out_len) < 0) {
+        g_free(*out_buf);
+        *out_buf = NULL;
+    }
 }
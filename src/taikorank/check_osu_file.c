@@ -26,9 +26,14 @@
 
 int tr_check_file(const char *file_name)
 {
-    // cheking that it's a .osu file
+    // cheking that it's a .osu or .osr file
+    int type;
     int length = strlen(file_name);
-    if (strncmp(".osu", &file_name[length-4], 5) != 0)
+    if (length >= 4 && strncmp(".osu", &file_name[length-4], 5) == 0)
+        type = TR_FILENAME_OSU_FILE;
+    else if (length >= 4 && strncmp(".osr", &file_name[length-4], 5) == 0)
+        type = TR_FILENAME_REPLAY_FILE;
+    else
         return TR_FILENAME_HASH; // that's a hash
 
     // check that the file existence
@@ -36,5 +41,5 @@ int tr_check_file(const char *file_name)
         tr_error("%s: cannot open file for reading", file_name);
         return TR_FILENAME_ERROR;
     }
-    return TR_FILENAME_OSU_FILE;
+    return type;
 }
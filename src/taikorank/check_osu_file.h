@@ -20,6 +20,7 @@ enum tr_load_osu {
     TR_FILENAME_ERROR = 0,
     TR_FILENAME_OSU_FILE = 1,
     TR_FILENAME_HASH = 2,
+    TR_FILENAME_REPLAY_FILE = 3,
 };
 
 int tr_check_file(const char *file_name);
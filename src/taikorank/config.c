@@ -66,6 +66,9 @@ void tr_global_config_print(const struct tr_global_config *conf)
 
     fprintf(OUTPUT_INFO, "bdb_enable: %d\n", conf->beatmap_db_enable);
     fprintf(OUTPUT_INFO, "bdb_path:   %s\n", conf->beatmap_db_path);
+
+    fprintf(OUTPUT_INFO, "cache_enable: %d\n", conf->cache_enable);
+    fprintf(OUTPUT_INFO, "cache_path:   %s\n", conf->cache_path);
 }
 
 //-----------------------------------------------------
@@ -109,6 +112,9 @@ static void config_init(void)
     GLOBAL_CONFIG->beatmap_db_enable = cst_i(ht_conf, "osuxdb_enable");
     GLOBAL_CONFIG->beatmap_db_path   = cst_str(ht_conf, "osuxdb_path");
 
+    GLOBAL_CONFIG->cache_enable = cst_i(ht_conf, "cache_enable");
+    GLOBAL_CONFIG->cache_path   = cst_str(ht_conf, "cache_path");
+
     LOCAL_CONFIG->flat     = cst_i(ht_conf, "flat");
     LOCAL_CONFIG->no_bonus = cst_i(ht_conf, "no_bonus");
     local_config_set_mods(cst_str(ht_conf, "mods"));
@@ -217,7 +223,29 @@ void init_enabled(void)
 {
     if (GLOBAL_CONFIG->db_enable)
         tr_db_init();
-    if (GLOBAL_CONFIG->beatmap_db_enable)
-        osux_beatmap_db_init(&GLOBAL_CONFIG->beatmap_db,
-                             GLOBAL_CONFIG->beatmap_db_path, ".", false);
+    if (GLOBAL_CONFIG->beatmap_db_enable) {
+        int err = osux_beatmap_db_init(&GLOBAL_CONFIG->beatmap_db,
+                                       GLOBAL_CONFIG->beatmap_db_path, ".",
+                                       OSUX_BEATMAP_DB_READ_ONLY);
+        if (err < 0) {
+            tr_error("could not open beatmap database '%s': %s",
+                     GLOBAL_CONFIG->beatmap_db_path, osux_errmsg(err));
+            GLOBAL_CONFIG->beatmap_db_enable = 0;
+        }
+    }
+    if (GLOBAL_CONFIG->beatmap_db_enable) {
+        // every hash given on the command line is then a binary search
+        char *sidecar = g_strconcat(GLOBAL_CONFIG->beatmap_db_path,
+                                    ".hashidx", NULL);
+        if (osux_beatmap_db_load_hash_index(&GLOBAL_CONFIG->beatmap_db,
+                                            sidecar) < 0)
+            tr_error("could not load beatmap hash index");
+        g_free(sidecar);
+    }
+    if (GLOBAL_CONFIG->cache_enable &&
+        g_mkdir_with_parents(GLOBAL_CONFIG->cache_path, 0755) < 0) {
+        tr_error("could not create beatmap cache '%s'",
+                 GLOBAL_CONFIG->cache_path);
+        GLOBAL_CONFIG->cache_enable = 0;
+    }
 }
@@ -49,6 +49,9 @@ struct tr_global_config {
     int beatmap_db_enable;
     char *beatmap_db_path;
     osux_beatmap_db beatmap_db;
+
+    int cache_enable;
+    char *cache_path;
 };
 
 struct tr_local_config {
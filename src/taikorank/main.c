@@ -17,8 +17,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "osux.h"
+
 #include "taiko_ranking_map.h"
 #include "taiko_ranking_score.h"
+#include "tr_replay.h"
+#include "check_osu_file.h"
 #include "print.h"
 
 #include "options.h"
@@ -53,38 +57,136 @@ static void tr_initialize(void)
     tr_final_star_initialize();
 }
 
+// ranking a map costs more than parsing it: one parsing thread is
+// enough for this many processors
+#define TR_PROCESSORS_PER_PARSER 4
+
+struct tr_load {
+    GPtrArray *paths;
+    GPtrArray *confs;
+    GPtrArray *replays; // NULL for beatmaps given directly
+};
+
+// beatmap path of a .osu, a hash or the beatmap of a .osr
+static char *tr_get_path(const char *arg, struct osux_replay_ **replay)
+{
+    *replay = NULL;
+    if (tr_check_file(arg) != TR_FILENAME_REPLAY_FILE)
+        return trm_get_beatmap_path(arg);
+
+    *replay = tr_replay_new(arg);
+    if (*replay == NULL)
+        return NULL;
+    char *path = tr_replay_get_beatmap_path(*replay);
+    if (path == NULL) {
+        tr_replay_free(*replay);
+        *replay = NULL;
+    }
+    return path;
+}
+
+static void tr_load_map(osux_beatmap *beatmap, unsigned index,
+                        int err, void *user_data)
+{
+    struct tr_load *load = user_data;
+    struct tr_local_config *conf = g_ptr_array_index(load->confs, index);
+    struct osux_replay_ *replay = g_ptr_array_index(load->replays, index);
+    // owned by this map from now on, the arrays only free what is left
+    load->confs->pdata[index] = NULL;
+    load->replays->pdata[index] = NULL;
+
+    if (err < 0) {
+        tr_error("Cannot open beatmap '%s': %s",
+                 (char *) g_ptr_array_index(load->paths, index),
+                 osux_errmsg(err));
+        tr_local_config_free(conf);
+        tr_replay_free(replay);
+        return;
+    }
+
+    struct tr_map *map = trm_new_from_beatmap(beatmap);
+    if (map == NULL) {
+        tr_local_config_free(conf);
+        tr_replay_free(replay);
+        return;
+    }
+
+    map->conf = conf;
+    if (replay != NULL) {
+        // the actual play is ranked, nothing is simulated
+        err = trm_apply_replay(map, beatmap, replay);
+        tr_replay_free(replay);
+        if (err < 0) {
+            tr_local_config_free(conf);
+            trm_free(map);
+            return;
+        }
+        map->conf->tr_main = trm_main;
+    }
+    #pragma omp task firstprivate(map)
+    {
+        map->conf->tr_main(map);
+        tr_local_config_free(map->conf);
+        trm_free(map);
+    }
+}
+
 int main(int argc, char *argv[])
 {
     tr_initialize();
 
     int nb_map = 0;
     int start = apply_global_options(argc, (const char **) argv);
+    struct tr_load load;
+    load.paths = g_ptr_array_new_with_free_func(g_free);
+    load.confs = g_ptr_array_new_with_free_func(
+        (GDestroyNotify) tr_local_config_free);
+    load.replays = g_ptr_array_new_with_free_func(
+        (GDestroyNotify) tr_replay_free);
 
-    #pragma omp parallel
-    #pragma omp single
     for (int i = start; i < argc; i++) {
         if (argv[i][0] == LOCAL_OPT_PREFIX[0]) {
             i += local_opt_set(argc - i, (const char **) &argv[i]);
         } else {
             nb_map++;
-            struct tr_map *map = trm_new(argv[i]);
-            if (map == NULL)
+            struct osux_replay_ *replay;
+            char *path = tr_get_path(argv[i], &replay);
+            if (path == NULL)
                 continue;
-
-            map->conf = tr_local_config_copy();
-            #pragma omp task firstprivate(map)
-            {
-                map->conf->tr_main(map);
-                tr_local_config_free(map->conf);
-                trm_free(map);
-            }
+            g_ptr_array_add(load.paths, path);
+            g_ptr_array_add(load.confs, tr_local_config_copy());
+            g_ptr_array_add(load.replays, replay);
         }
     }
 
+    // the processors are shared between the parsing threads and the
+    // OpenMP team running the tasks, plus the thread delivering the
+    // beatmaps which mostly waits for them
+    unsigned processors = g_get_num_processors();
+    osux_beatmap_load_options options = {
+        .cache_dir = GLOBAL_CONFIG->cache_enable ?
+            GLOBAL_CONFIG->cache_path : NULL,
+        .thread_count = MAX(1, processors / TR_PROCESSORS_PER_PARSER),
+    };
+    // beatmaps are parsed by osux worker threads,
+    // each loaded map is then processed in its own task
+    int err = 0;
+    #pragma omp parallel num_threads(processors - options.thread_count + 1)
+    #pragma omp single
+    err = osux_beatmap_load_many_ex(
+        (char const *const *) load.paths->pdata, load.paths->len,
+        &options, tr_load_map, &load);
+    if (err < 0)
+        tr_error("Cannot load beatmaps: %s", osux_errmsg(err));
+
+    g_ptr_array_free(load.paths, TRUE);
+    g_ptr_array_free(load.confs, TRUE);
+    g_ptr_array_free(load.replays, TRUE);
+
     if (nb_map == 0) {
         tr_error("No osu file D:");
         print_help();
     }
 
-    return EXIT_SUCCESS;
+    return err < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
 }
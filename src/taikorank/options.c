@@ -186,6 +186,16 @@ static void opt_bdb_path(const char **argv)
     GLOBAL_CONFIG->beatmap_db_path = (char*) argv[0];
 }
 
+static void opt_cache(const char **argv)
+{
+    GLOBAL_CONFIG->cache_enable = atoi(argv[0]);
+}
+
+static void opt_cache_path(const char **argv)
+{
+    GLOBAL_CONFIG->cache_path = (char*) argv[0];
+}
+
 //-----------------------------------------------------
 
 static void tr_option_print(const char *key UNUSED,
@@ -266,6 +276,10 @@ void tr_options_initialize(void)
                       "Enable or disable beatmap database lookup");
     new_tr_global_opt("bdb_path", 1, opt_bdb_path,
                       "Set the path to the beatmap database");
+    new_tr_global_opt("cache", 1, opt_cache,
+                      "Enable or disable the parsed beatmap cache");
+    new_tr_global_opt("cache_path", 1, opt_cache_path,
+                      "Set the directory of the parsed beatmap cache");
 
     new_tr_global_opt("ptro", 1, opt_print_tro,
                       "Enable or disable object printing");
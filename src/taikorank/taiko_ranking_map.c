@@ -38,7 +38,7 @@
 // more easily
 
 static int get_tro_type_from_osux_ho(osux_hitobject *ho);
-static double get_bpm_app_from_osux_tp(osux_timingpoint *tp,
+static double get_bpm_app_from_osux_tp(osux_timingpoint const *tp,
                                        double sv);
 static void trm_add_to_ps(struct tr_map *map,
                           enum played_state ps, int i);
@@ -137,14 +137,13 @@ void trm_free(struct tr_map *map)
 
 //--------------------------------------------------
 
-struct tr_map *trm_new(const char *filename)
+char *trm_get_beatmap_path(const char *filename)
 {
-    struct tr_map *res = NULL;
     char *path = NULL;
 
     switch ( tr_check_file(filename) ) {
     case TR_FILENAME_OSU_FILE:
-        res = trm_from_file(filename);
+        path = g_strdup(filename);
         break;
     case TR_FILENAME_HASH:
         if (!GLOBAL_CONFIG->beatmap_db_enable) {
@@ -153,22 +152,36 @@ struct tr_map *trm_new(const char *filename)
         }
         path = osux_beatmap_db_get_path_by_hash(&GLOBAL_CONFIG->beatmap_db,
                                                 filename);
-        if (path == NULL) {
+        if (path == NULL)
             tr_error("could not find beatmap for hash '%s'", filename);
-            break;
-        }
-        res = trm_from_file(path);
+        break;
+    case TR_FILENAME_REPLAY_FILE:
+        tr_error("'%s' is a replay, not a beatmap", filename);
         break;
     case TR_FILENAME_ERROR:
     default:
         tr_error("Could not load: '%s'", filename);
         break;
     }
+    return path;
+}
 
+struct tr_map *trm_new(const char *filename)
+{
+    struct tr_map *res = NULL;
+    char *path = trm_get_beatmap_path(filename);
+
+    if (path != NULL)
+        res = trm_from_file(path);
     g_free(path);
     return res;
 }
 
+struct tr_map *trm_new_from_beatmap(struct osux_beatmap_ *map)
+{
+    return trm_from_osux_map(map);
+}
+
 //---------------------------------------------------------------
 //---------------------------------------------------------------
 //---------------------------------------------------------------
@@ -196,7 +209,7 @@ static int get_tro_type_from_osux_ho(osux_hitobject *ho)
 
 //---------------------------------------------------------------
 
-static double get_bpm_app_from_osux_tp(osux_timingpoint *tp, double sv)
+static double get_bpm_app_from_osux_tp(osux_timingpoint const *tp, double sv)
 {
     double sv_multiplication;
 
@@ -260,21 +273,17 @@ static void trm_from_osux_map_objects(struct tr_map *tr_map,
     tr_map->nb_object = map->hitobject_count;
     tr_map->object = calloc(sizeof(struct tr_object), map->hitobject_count);
 
-    unsigned current_tp = 0;
     tr_map->max_combo = 0;
     for (unsigned i = 0; i < map->hitobject_count; i++) {
-        while (current_tp < (map->timingpoint_count - 1) &&
-               map->timingpoints[current_tp + 1].offset
-               <= map->hitobjects[i].offset)
-            current_tp++;
-
         struct tr_object *o  = &tr_map->object[i];
         osux_hitobject *ho   = &map->hitobjects[i];
-        osux_timingpoint *tp = &map->timingpoints[current_tp];
+        osux_timingpoint const *tp = osux_timing_index_lookup(
+            &map->timing_index, ho->offset);
 
         o->offset  = (int) ho->offset;
         o->bf      = get_tro_type_from_osux_ho(ho);
-        o->bpm_app = get_bpm_app_from_osux_tp(tp, map->SliderMultiplier);
+        o->bpm_app = tp == NULL ? 0. :
+            get_bpm_app_from_osux_tp(tp, map->SliderMultiplier);
         o->end_offset = ho->end_offset;
 
         if (tro_is_bonus(o)) {
@@ -588,6 +597,29 @@ void trm_set_tro_ps(struct tr_map *map, int x, enum played_state ps)
 
 //--------------------------------------------------
 
+void trm_set_tros_ps(struct tr_map *map, const enum played_state *ps)
+{
+    for (int i = 0; i < map->nb_object; i++) {
+        struct tr_object *o = &map->object[i];
+        if (o->ps == ps[i] || o->ps == BONUS || ps[i] == BONUS)
+            continue;
+        trm_add_to_ps(map, o->ps, -1);
+        trm_add_to_ps(map, ps[i], 1);
+        o->ps = ps[i];
+        if (ps[i] == GOOD) {
+            o->density_star = 0;
+            o->reading_star = 0;
+            o->pattern_star = 0;
+            o->accuracy_star = 0;
+            o->final_star = 0;
+        }
+    }
+    trm_recompute_acc(map);
+    trm_set_combo(map);
+}
+
+//--------------------------------------------------
+
 double compute_acc(int great, int good, int miss)
 {
     return (great + good * 0.5) / (great + good + miss) * MAX_ACC;
@@ -17,6 +17,7 @@
 #define TR_MAP_H
 
 struct tr_object;
+struct osux_beatmap_;
 enum played_state;
 
 #define MAX_ACC 100.
@@ -68,6 +69,8 @@ struct tr_map
 //----------------------------------------
 
 struct tr_map *trm_new(const char *filename);
+struct tr_map *trm_new_from_beatmap(struct osux_beatmap_ *map);
+char *trm_get_beatmap_path(const char *filename);
 struct tr_map *trm_copy(const struct tr_map *map);
 void trm_free(struct tr_map *map);
 
@@ -75,6 +78,8 @@ int trm_get_hardest_tro(const struct tr_map *map);
 int trm_get_best_influence_tro(const struct tr_map *map);
 
 void trm_set_tro_ps(struct tr_map *map, int x, enum played_state ps);
+// set every object state at once, 'ps' has map->nb_object elements
+void trm_set_tros_ps(struct tr_map *map, const enum played_state *ps);
 double compute_acc(int great, int good, int miss);
 
 void trm_set_read_only_objects(struct tr_map *map);
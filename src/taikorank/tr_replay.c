@@ -0,0 +1,107 @@
+/*
+ *  Copyright (©) 2015-2016 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "osux.h"
+
+#include "taiko_ranking_object.h"
+#include "taiko_ranking_map.h"
+#include "tr_replay.h"
+#include "config.h"
+#include "print.h"
+
+// osux_hits_taiko_states gives taikorank's played states
+G_STATIC_ASSERT((int) OSUX_TAIKO_GREAT == GREAT);
+G_STATIC_ASSERT((int) OSUX_TAIKO_GOOD  == GOOD);
+G_STATIC_ASSERT((int) OSUX_TAIKO_MISS  == MISS);
+G_STATIC_ASSERT((int) OSUX_TAIKO_BONUS == BONUS);
+
+//--------------------------------------------------
+
+struct osux_replay_ *tr_replay_new(const char *filename)
+{
+    osux_replay *replay = g_malloc(sizeof(*replay));
+    int err = osux_replay_init_ex(replay, filename,
+                                  OSUX_REPLAY_SKIP_LIFE_GRAPH);
+    if (err < 0) {
+        tr_error("Cannot open replay '%s': %s", filename, osux_errmsg(err));
+        g_free(replay);
+        return NULL;
+    }
+    if (replay->game_mode != GAME_MODE_TAIKO) {
+        tr_error("'%s' is not a taiko replay", filename);
+        tr_replay_free(replay);
+        return NULL;
+    }
+    return replay;
+}
+
+void tr_replay_free(struct osux_replay_ *replay)
+{
+    if (replay == NULL)
+        return;
+    osux_replay_free(replay);
+    g_free(replay);
+}
+
+//--------------------------------------------------
+
+char *tr_replay_get_beatmap_path(const struct osux_replay_ *replay)
+{
+    if (!GLOBAL_CONFIG->beatmap_db_enable) {
+        tr_error("database lookup disabled, cannot find replay beatmap");
+        return NULL;
+    }
+    char *path = osux_beatmap_db_get_path_by_hash(&GLOBAL_CONFIG->beatmap_db,
+                                                  replay->beatmap_hash);
+    if (path == NULL)
+        tr_error("could not find beatmap for hash '%s'",
+                 replay->beatmap_hash);
+    return path;
+}
+
+//--------------------------------------------------
+
+int trm_apply_replay(struct tr_map *map, const struct osux_beatmap_ *beatmap,
+                     const struct osux_replay_ *replay)
+{
+    osux_hits hits;
+    int err = osux_hits_init(&hits, beatmap, replay);
+    if (err < 0) {
+        tr_error("Cannot judge replay: %s", osux_errmsg(err));
+        return err;
+    }
+    if ((int) hits.hits_size != map->nb_object) {
+        osux_hits_free(&hits);
+        tr_error("Replay judgement does not match the map objects");
+        return -OSUX_ERR_INVAL;
+    }
+
+    osux_taiko_state *states = g_new(osux_taiko_state, hits.hits_size);
+    enum played_state *ps = g_new(enum played_state, hits.hits_size);
+    err = osux_hits_taiko_states(&hits, beatmap, states);
+    if (err == 0) {
+        for (int i = 0; i < map->nb_object; i++)
+            ps[i] = (enum played_state) states[i];
+        trm_set_tros_ps(map, ps);
+        map->conf->mods = replay->mods;
+    }
+    g_free(states);
+    g_free(ps);
+    osux_hits_free(&hits);
+    return err;
+}
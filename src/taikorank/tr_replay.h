@@ -0,0 +1,34 @@
+/*
+ *  Copyright (©) 2015-2016 Lucas Maugère, Thomas Mijieux
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef TR_REPLAY_H
+#define TR_REPLAY_H
+
+struct tr_map;
+struct osux_beatmap_;
+struct osux_replay_;
+
+struct osux_replay_ *tr_replay_new(const char *filename);
+void tr_replay_free(struct osux_replay_ *replay);
+char *tr_replay_get_beatmap_path(const struct osux_replay_ *replay);
+
+/*
+ * Judge the replay on the beatmap the map was made from, and set the
+ * objects' played state and the map mods to the actual play.
+ */
+int trm_apply_replay(struct tr_map *map, const struct osux_beatmap_ *beatmap,
+                     const struct osux_replay_ *replay);
+
+#endif // TR_REPLAY_H
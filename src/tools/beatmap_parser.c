@@ -16,28 +16,102 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <glib.h>
 #include <glib/gstdio.h>
 
 #include "osux.h"
 
+static char *print_to_string(osux_beatmap const *bm)
+{
+    char *str = NULL;
+    size_t size = 0;
+    FILE *f = open_memstream(&str, &size);
+    if (f == NULL)
+        return NULL;
+    osux_beatmap_print(bm, f);
+    fclose(f);
+    return str;
+}
+
+/*
+ * save the beatmap in the binary format, load it back and compare it
+ * with the parsed one: the printed beatmaps and the statistics must match
+ */
+static int check_binary(osux_beatmap const *bm)
+{
+    int err;
+    GError *error = NULL;
+    char *path = NULL;
+    int fd = g_file_open_tmp("parse_beatmap-XXXXXX.osub", &path, &error);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot create temporary file: %s\n", error->message);
+        g_error_free(error);
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    osux_beatmap loaded;
+    if ((err = osux_beatmap_save_binary(bm, path)) < 0 ||
+        (err = osux_beatmap_load_binary(&loaded, path)) < 0) {
+        fprintf(stderr, "Binary round trip failed: %s\n", osux_errmsg(err));
+        g_unlink(path);
+        g_free(path);
+        return EXIT_FAILURE;
+    }
+    g_unlink(path);
+    g_free(path);
+
+    char *expected = print_to_string(bm);
+    char *actual = print_to_string(&loaded);
+    bool same = expected != NULL && actual != NULL && !strcmp(expected, actual)
+        && !g_strcmp0(bm->md5_hash, loaded.md5_hash)
+        && bm->hitobject_count == loaded.hitobject_count
+        && bm->circles == loaded.circles && bm->sliders == loaded.sliders
+        && bm->spinners == loaded.spinners
+        && bm->drain_time == loaded.drain_time
+        && bm->total_time == loaded.total_time
+        && bm->bpm_min == loaded.bpm_min && bm->bpm_max == loaded.bpm_max;
+    for (unsigned i = 0; same && i < bm->hitobject_count; ++i)
+        same = bm->hitobjects[i].offset == loaded.hitobjects[i].offset
+            && bm->hitobjects[i].end_offset == loaded.hitobjects[i].end_offset;
+    free(expected);
+    free(actual);
+    osux_beatmap_free(&loaded);
+
+    if (!same) {
+        fprintf(stderr, "Binary round trip differs from the parsed beatmap\n");
+        return EXIT_FAILURE;
+    }
+    printf("binary round trip: ok\n");
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char *argv[])
 {
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s /path/to/beatmap.osu\n", argv[0]);
+    bool check = argc == 3 && !strcmp(argv[1], "--check-binary");
+    if (argc != 2 && !check) {
+        fprintf(stderr, "Usage: %s [--check-binary] /path/to/beatmap.osu\n",
+                argv[0]);
         exit(EXIT_FAILURE);
     }
+    char const *file_path = argv[argc - 1];
 
     int err;
     osux_beatmap bm;
-    if ((err = osux_beatmap_init(&bm, argv[1])) < 0) {
+    if ((err = osux_beatmap_init(&bm, file_path)) < 0) {
         fprintf(stderr, "Cannot parse beatmap '%s': %s\n",
-                argv[1], osux_errmsg(err));
+                file_path, osux_errmsg(err));
         return EXIT_FAILURE;
     }
 
-    osux_beatmap_print(&bm, stdout);
+    int status = EXIT_SUCCESS;
+    if (check)
+        status = check_binary(&bm);
+    else
+        osux_beatmap_print(&bm, stdout);
     osux_beatmap_free(&bm);
 
-    return EXIT_SUCCESS;
+    return status;
 }
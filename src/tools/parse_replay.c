@@ -16,12 +16,14 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <locale.h>
 
 #include "osux.h"
 
 int main(int argc, char *argv[])
 {
     char *path = NULL;
+    setlocale(LC_ALL, "");
     if (argc != 2)  {
         fprintf(stderr, "Usage: %s /path/to/replay.osr\n", argv[0]);
         exit(EXIT_FAILURE);
@@ -35,7 +37,8 @@ int main(int argc, char *argv[])
     osux_replay_print(&r, stdout);
 
     osux_beatmap_db db;
-    if (osux_beatmap_db_init(&db, "./osux.sqlite", ".", false) == 0) {
+    if (osux_beatmap_db_init(&db, "./osux.sqlite", ".",
+                             OSUX_BEATMAP_DB_READ_ONLY) == 0) {
         path = osux_beatmap_db_get_path_by_hash(&db, r.beatmap_hash);
         if (path != NULL)
             printf("Replay map: %s\n", path);
@@ -53,8 +56,18 @@ int main(int argc, char *argv[])
         }
 
         osux_hits hits;
-        osux_hits_init(&hits, &bm, &r);
-        osux_hits_free(&hits);
+        int err = osux_hits_init_ex(&hits, &bm, &r,
+                                    &osux_hits_print_debug, stdout);
+        if (err < 0)
+            fprintf(stderr, "Cannot judge replay: %s\n", osux_errmsg(err));
+        else {
+            osux_hit_analysis analysis;
+            if (osux_hit_analysis_init(&analysis, &hits, &bm, 0) == 0) {
+                osux_hit_analysis_print(&analysis, stdout);
+                osux_hit_analysis_free(&analysis);
+            }
+            osux_hits_free(&hits);
+        }
 
         osux_beatmap_free(&bm);
     }
@@ -102,9 +102,11 @@ void vosu_beatmap_configure_view(VosuBeatmap *b, VosuView *view)
 {
     osux_beatmap *pBm = &b->xbeatmap;
     int64_t end_time, beatlength = 1000;
+    osux_timingpoint const *tp;
     end_time = pBm->hitobjects[pBm->hitobject_count-1].offset;
-    if (pBm->timingpoint_count > 0)
-        beatlength = pBm->timingpoints[0].millisecond_per_beat;
+    tp = osux_timing_index_uninherited_at(&pBm->timing_index, 0);
+    if (tp != NULL)
+        beatlength = tp->millisecond_per_beat;
 
     vosu_view_set_beatmap_properties(
         view, end_time+2000, beatlength, pBm->Mode, b->HitObjectsSeq,